@@ -0,0 +1,125 @@
+#include "Batch.hpp"
+#include "Minimax.hpp"
+#include "PerfectPlay.hpp"
+
+#include <cassert>
+#include <algorithm>
+#include <iostream>
+
+namespace solution {
+
+BatchSolver::BatchSolver(Factory_t && factory, size_t threads)
+    : m_workers(threads)
+{
+    assert(threads > 0 && "At least one thread is required");
+    for(auto& worker: m_workers) {
+        worker.m_solvers[0] = factory(0);
+        worker.m_solvers[1] = factory(1);
+    }
+    // the first worker belongs to the thread calling `RunBatch`
+    m_threads.reserve(threads - 1);
+    for(size_t i = 1; i < threads; i++) {
+        m_threads.emplace_back([this, i]() {
+            this->Loop(m_workers[i]);
+        });
+    }
+}
+
+BatchSolver::~BatchSolver() {
+    {
+        std::lock_guard<std::mutex> lock { m_mutex };
+        m_stopped = true;
+    }
+    m_started.notify_all();
+    for(auto& thread: m_threads) {
+        thread.join();
+    }
+}
+
+void BatchSolver::RunBatch(const Game* games, size_t count, size_t* moves, const Deadline& deadline) {
+    {
+        std::lock_guard<std::mutex> lock { m_mutex };
+        m_games = games;
+        m_count = count;
+        m_moves = moves;
+        m_deadline = deadline;
+        m_next = 0;
+        m_running = m_threads.size();
+        m_batch++;
+    }
+    m_started.notify_all();
+    this->Solve(m_workers.front());
+
+    std::unique_lock<std::mutex> lock { m_mutex };
+    m_finished.wait(lock, [this]() { return m_running == 0; });
+}
+
+void BatchSolver::Loop(Worker& worker) {
+    uint64_t batch { 0 };
+    while(true) {
+        {
+            std::unique_lock<std::mutex> lock { m_mutex };
+            m_started.wait(lock, [this, batch]() { return m_stopped || m_batch != batch; });
+            if(m_stopped) {
+                return;
+            }
+            batch = m_batch;
+        }
+        this->Solve(worker);
+        {
+            std::lock_guard<std::mutex> lock { m_mutex };
+            m_running--;
+        }
+        m_finished.notify_one();
+    }
+}
+
+void BatchSolver::Solve(Worker& worker) {
+    for(auto first = m_next.fetch_add(CHUNK_SIZE); first < m_count; first = m_next.fetch_add(CHUNK_SIZE)) {
+        const auto last = std::min(first + CHUNK_SIZE, m_count);
+        for(auto i = first; i < last; i++) {
+            const auto& game = m_games[i];
+            assert(game.m_player <= 1 && "Player ID must belong to range [0, 1]");
+            m_moves[i] = worker.m_solvers[game.m_player]->Run(game.m_board, m_deadline);
+        }
+    }
+}
+
+} // namespace solution
+
+void TestBatchSolver() {
+    using game::Board;
+    using solution::BatchSolver;
+    std::cerr << "Test the batch solver...\n";
+    solution::PerfectPlay perfect[2] = { solution::PerfectPlay { 0 }, solution::PerfectPlay { 1 } };
+
+    // all positions after 'x' and 'o' moves
+    std::vector<BatchSolver::Game> games;
+    for(size_t i = 0; i < Board::SIZE; i++) {
+        for(size_t j = 0; j < Board::SIZE; j++) {
+            if(i != j) {
+                Board board;
+                board.assign(i / 3, i % 3, Board::Cell::X);
+                board.assign(j / 3, j % 3, Board::Cell::O);
+                games.push_back(BatchSolver::Game { board, 0 });
+            }
+        }
+    }
+    std::vector<size_t> moves(games.size());
+    BatchSolver batch {
+        [](uint8_t player) {
+            return std::unique_ptr<solution::Solver>(
+                new solution::AlphaBettaMinimax { player });
+        }
+        , 3
+    };
+    // the same solvers are reused by the next batch
+    for(size_t run = 0; run < 2; run++) {
+        batch.RunBatch(games.data(), games.size(), moves.data());
+        for(size_t i = 0; i < games.size(); i++) {
+            assert(moves[i] == perfect[games[i].m_player].Run(games[i].m_board)
+                && "Batch solver disagrees with the perfect play");
+        }
+    }
+    std::cerr << "Complete test.\n";
+}
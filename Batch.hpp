@@ -0,0 +1,99 @@
+#ifndef BATCH_HPP_
+#define BATCH_HPP_
+
+#include "Solver.hpp"
+
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <mutex>
+
+namespace solution {
+
+/**
+ * Solves many independent games at once.
+ * The games of a batch are shared between the threads of the pool
+ * which live as long as the batch solver. Each thread owns a solver
+ * for each player created once by the factory, so its memory
+ * (e.g. the node pool of `MCTS`) is reused by all games of all batches
+ * and doesn't depend on the batch size.
+ */
+class BatchSolver final {
+public:
+    using Factory_t = std::function<std::unique_ptr<Solver>(uint8_t player)>;
+
+    struct Game {
+        Solver::State_t m_board {};
+        // the player to move: [0, 1]
+        uint8_t         m_player { 0 };
+    };
+
+    /**
+     * @param factory creates a solver for the given player, e.g. `Minimax`, `AlphaBettaMinimax` or `MCTS`
+     * @param threads number of threads solving the games (the calling thread is one of them)
+     */
+    BatchSolver(Factory_t && factory, size_t threads);
+
+    BatchSolver(const BatchSolver&) = delete;
+    BatchSolver& operator=(const BatchSolver&) = delete;
+
+    ~BatchSolver();
+
+    /**
+     * Blocks until all games are solved
+     * @param games the games to solve
+     * @param count number of games
+     * @param moves receives the best move for each game: `moves[i]` is the move for `games[i]`
+     * @param deadline is shared by all games: once it expires the rest are solved
+     * by the first moves the solvers find
+     */
+    void RunBatch(const Game* games, size_t count, size_t* moves, const Deadline& deadline = Deadline{});
+
+    size_t Threads() const noexcept {
+        return m_workers.size();
+    }
+
+private:
+    // number of games taken by a worker at once
+    static constexpr size_t CHUNK_SIZE { 16 };
+
+    struct Worker {
+        // [player] - the solver used for the games of the player
+        std::unique_ptr<Solver> m_solvers[2];
+    };
+
+    // wait for batches and solve them until the solver is destroyed
+    void Loop(Worker& worker);
+
+    // take the games of the current batch by chunks until nothing is left
+    void Solve(Worker& worker);
+
+    std::vector<Worker>         m_workers{};
+    std::vector<std::thread>    m_threads{};
+
+    std::mutex                  m_mutex;
+    std::condition_variable     m_started;
+    std::condition_variable     m_finished;
+    // number of the current batch, workers wait for the change
+    uint64_t                    m_batch { 0 };
+    // number of pool threads still solving the current batch
+    size_t                      m_running { 0 };
+    bool                        m_stopped { false };
+
+    // the current batch
+    const Game*                 m_games { nullptr };
+    size_t                      m_count { 0 };
+    size_t*                     m_moves { nullptr };
+    Deadline                    m_deadline{};
+    // index of the first game which isn't taken yet
+    std::atomic<size_t>         m_next { 0 };
+};
+
+} // namespace solution
+
+void TestBatchSolver();
+
+#endif // BATCH_HPP_
@@ -0,0 +1,424 @@
+#include "Board.hpp"
+#include "ElementPool.hpp"
+#include "Minimax.hpp"
+#include "Negamax.hpp"
+#include "MCTS.hpp"
+#include "PerfectPlay.hpp"
+#include "Random.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+/**
+ * Benchmark of the solvers and the hot primitives over a fixed corpus of positions.
+ * Usage: tic-tac-toe-benchmark [--format json|csv] [--repeat N]
+ * The report is written to stdout.
+ */
+
+namespace {
+
+// number of heap allocations made by the process
+std::atomic<uint64_t> g_allocations { 0 };
+
+} // namespace
+
+void* operator new(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if(auto memory = std::malloc(size? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    std::free(memory);
+}
+
+namespace {
+
+using game::Board;
+using Clock = std::chrono::steady_clock;
+
+struct Position {
+    const char* m_corpus;
+    // cells row by row: 'x', 'o' or '.'
+    const char* m_cells;
+};
+
+// 'x' moves first so the number of marks defines the player to move
+constexpr Position CORPUS[] = {
+    { "opening", "........." },
+    { "opening", "x........" },
+    { "opening", "....x...." },
+    { "opening", ".x......." },
+    { "opening", "x...o...." },
+    { "opening", "....x...o" },
+    { "midgame", "x...o...x" },
+    { "midgame", "x.o.x...o" },
+    { "midgame", ".x..o.x.." },
+    { "midgame", "xo..x...o" },
+    { "midgame", "o.x.x...." },
+    { "midgame", "x.x.o.o.." },
+    { "endgame", "xoxox...o" },
+    { "endgame", "xoxxo.o.." },
+    { "endgame", "oxxxo...o" },
+    { "endgame", "xo.oxx.o." },
+    { "endgame", "xxo.oxo.x" },
+    { "endgame", "xoxoxo..." },
+};
+
+Board ToBoard(const char* cells) {
+    Board board;
+    for(size_t i = 0; i < Board::SIZE; i++) {
+        if(cells[i] != '.') {
+            board.assign(i / 3, i % 3, cells[i] == 'x'? Board::Cell::X : Board::Cell::O);
+        }
+    }
+    return board;
+}
+
+uint8_t ToPlayer(const char* cells) {
+    const auto marks = Board::SIZE - static_cast<size_t>(std::count(cells, cells + Board::SIZE, '.'));
+    return static_cast<uint8_t>(marks % 2);
+}
+
+struct Report {
+    std::string m_name;
+    std::string m_corpus;
+    size_t      m_calls { 0 };
+    // latency of a call in nanoseconds
+    double      m_mean { 0. };
+    double      m_p50 { 0. };
+    double      m_p90 { 0. };
+    double      m_p99 { 0. };
+    // 0 when the benchmark doesn't count them
+    double      m_nodesPerSecond { 0. };
+    double      m_playoutsPerSecond { 0. };
+    double      m_allocationsPerCall { 0. };
+    // the oracle benchmark: the iteration limit of the solver and the share of the moves
+    // as good as the perfect play's ones
+    uint64_t    m_iterationLimit { 0 };
+    double      m_optimalRate { 0. };
+};
+
+// collects latencies and counters of the benchmark's calls
+class Recorder {
+public:
+    Recorder(std::string name, std::string corpus)
+    {
+        m_report.m_name = std::move(name);
+        m_report.m_corpus = std::move(corpus);
+    }
+
+    // the call is measured as `calls` calls of the same duration (used for too short calls)
+    void Add(Clock::duration duration, uint64_t allocations, uint64_t nodes = 0, uint64_t playouts = 0, size_t calls = 1) {
+        const auto ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+        m_latencies.push_back(ns / static_cast<double>(calls));
+        m_total += ns;
+        m_calls += calls;
+        m_allocations += allocations;
+        m_nodes += nodes;
+        m_playouts += playouts;
+    }
+
+    Report Finish() {
+        std::sort(m_latencies.begin(), m_latencies.end());
+        const auto percentile = [this](double p) {
+            if(m_latencies.empty()) {
+                return 0.;
+            }
+            const auto rank = static_cast<size_t>(p * static_cast<double>(m_latencies.size() - 1) + 0.5);
+            return m_latencies[rank];
+        };
+        const auto seconds = m_total * 1e-9;
+        m_report.m_calls = m_calls;
+        m_report.m_mean = m_calls? m_total / static_cast<double>(m_calls) : 0.;
+        m_report.m_p50 = percentile(0.5);
+        m_report.m_p90 = percentile(0.9);
+        m_report.m_p99 = percentile(0.99);
+        m_report.m_nodesPerSecond = seconds > 0.? static_cast<double>(m_nodes) / seconds : 0.;
+        m_report.m_playoutsPerSecond = seconds > 0.? static_cast<double>(m_playouts) / seconds : 0.;
+        m_report.m_allocationsPerCall = m_calls? static_cast<double>(m_allocations) / static_cast<double>(m_calls) : 0.;
+        return m_report;
+    }
+
+private:
+    Report              m_report;
+    std::vector<double> m_latencies;
+    double              m_total { 0. };
+    size_t              m_calls { 0 };
+    uint64_t            m_allocations { 0 };
+    uint64_t            m_nodes { 0 };
+    uint64_t            m_playouts { 0 };
+};
+
+/**
+ * Run the solver (one instance per player) for every position of each corpus
+ * @param counters returns the number of nodes and playouts of the last `Run` of the solver
+ */
+template<class SolverType>
+void BenchSolver(const std::string& name
+    , std::function<std::unique_ptr<SolverType>(uint8_t)> factory
+    , std::function<std::pair<uint64_t, uint64_t>(const SolverType&)> counters
+    , size_t repeat
+    , std::vector<Report>& reports
+) {
+    std::unique_ptr<SolverType> solvers[2] = { factory(0), factory(1) };
+    for(const auto corpus: { "opening", "midgame", "endgame" }) {
+        Recorder recorder { name, corpus };
+        for(size_t r = 0; r < repeat; r++) {
+            for(const auto& position: CORPUS) {
+                if(std::strcmp(position.m_corpus, corpus) != 0) {
+                    continue;
+                }
+                auto& solver = *solvers[ToPlayer(position.m_cells)];
+                const auto board = ToBoard(position.m_cells);
+                const auto allocations = g_allocations.load(std::memory_order_relaxed);
+                const auto start = Clock::now();
+                solver.Run(board);
+                const auto duration = Clock::now() - start;
+                const auto [nodes, playouts] = counters(solver);
+                recorder.Add(duration, g_allocations.load(std::memory_order_relaxed) - allocations, nodes, playouts);
+            }
+        }
+        reports.push_back(recorder.Finish());
+    }
+}
+
+/**
+ * Quality of the MCTS decisions against the perfect play for the growing iteration limits:
+ * the smallest limit with all moves optimal is the number of iterations needed per decision
+ * @param raveEquivalence 0 - plain UCT, RAVE otherwise
+ * @param symmetric merge the symmetric children of the nodes
+ */
+void BenchOracle(const std::string& name, uint32_t raveEquivalence, bool symmetric, size_t repeat, std::vector<Report>& reports) {
+    for(const uint64_t iterations: { 50, 100, 200, 500, 1'000, 2'000, 5'000 }) {
+        Recorder recorder { name, "all" };
+        size_t optimal { 0 };
+        size_t moves { 0 };
+        for(size_t r = 0; r < repeat; r++) {
+            // new solvers for each repetition: the reused tree would hide the limit
+            std::unique_ptr<solution::MCTS> solvers[2];
+            for(uint8_t player = 0; player < 2; player++) {
+                solvers[player] = std::make_unique<solution::MCTS>(1'000'000'000, iterations, 100'000
+                    , player, 1, 1, raveEquivalence, symmetric);
+            }
+            for(const auto& position: CORPUS) {
+                const auto player = ToPlayer(position.m_cells);
+                auto& solver = *solvers[player];
+                const auto board = ToBoard(position.m_cells);
+                if(game::GetGameState(board).first != Board::State::ONGOING) {
+                    continue;
+                }
+                const auto allocations = g_allocations.load(std::memory_order_relaxed);
+                const auto start = Clock::now();
+                const auto move = solver.Run(board);
+                const auto duration = Clock::now() - start;
+                recorder.Add(duration, g_allocations.load(std::memory_order_relaxed) - allocations, 0, solver.Playouts());
+                auto best = -1;
+                for(const auto cell: game::Cells { board.freeCells() }) {
+                    best = std::max(best, solution::MoveValue(board, player, cell));
+                }
+                optimal += solution::MoveValue(board, player, move) == best;
+                moves++;
+            }
+        }
+        auto report = recorder.Finish();
+        report.m_iterationLimit = iterations;
+        report.m_optimalRate = static_cast<double>(optimal) / static_cast<double>(moves);
+        reports.push_back(report);
+    }
+}
+
+// random ongoing and finished positions of the larger boards along with their last moves
+template<class Board_t>
+std::vector<std::pair<Board_t, size_t>> RandomBoards(size_t count) {
+    solution::Xorshift32 random { 42u };
+    std::vector<std::pair<Board_t, size_t>> boards;
+    while(boards.size() < count) {
+        Board_t board;
+        size_t last { 0 };
+        const auto moves = 1U + random(static_cast<uint32_t>(Board_t::SIZE));
+        for(uint32_t i = 0; i < moves && game::GetGameState(board).first == game::State::ONGOING; i++) {
+            last = solution::RandomCell(game::Cells { board.freeCells() }, random);
+            board.assign(last, i % 2? game::Cell::O : game::Cell::X);
+        }
+        boards.emplace_back(board, last);
+    }
+    return boards;
+}
+
+/**
+ * @param name      "GetGameState" - the whole board is checked,
+ *                  "GetGameState (last move)" - only the lines through the last move
+ */
+template<class Board_t>
+void BenchGameState(const std::string& name
+    , const char* corpus
+    , const std::vector<std::pair<Board_t, size_t>>& boards
+    , size_t repeat
+    , std::vector<Report>& reports
+) {
+    // calls per measurement: a single call is too short for the clock
+    constexpr size_t BLOCK { 1024 };
+    const bool incremental = name != "GetGameState";
+    Recorder recorder { name, corpus };
+    size_t wins { 0 };
+    for(size_t r = 0; r < repeat * 64; r++) {
+        const auto allocations = g_allocations.load(std::memory_order_relaxed);
+        const auto start = Clock::now();
+        for(size_t i = 0; i < BLOCK; i++) {
+            const auto& [board, last] = boards[i % boards.size()];
+            const auto state = incremental? game::GetGameState(board, last) : game::GetGameState(board);
+            wins += state.first == game::State::WIN;
+        }
+        const auto duration = Clock::now() - start;
+        recorder.Add(duration, g_allocations.load(std::memory_order_relaxed) - allocations, 0, 0, BLOCK);
+    }
+    // keep the result alive
+    if(wins == 0) {
+        std::cerr << "No wins in the corpus\n";
+    }
+    reports.push_back(recorder.Finish());
+}
+
+template<class Board_t>
+void BenchGameState(const char* corpus, size_t repeat, std::vector<Report>& reports) {
+    const auto boards = RandomBoards<Board_t>(256);
+    BenchGameState("GetGameState", corpus, boards, repeat, reports);
+    BenchGameState("GetGameState (last move)", corpus, boards, repeat, reports);
+}
+
+void BenchGameState(size_t repeat, std::vector<Report>& reports) {
+    // the corpus has no last moves
+    std::vector<std::pair<Board, size_t>> boards;
+    for(const auto& position: CORPUS) {
+        boards.emplace_back(ToBoard(position.m_cells), 0);
+    }
+    BenchGameState("GetGameState", "all", boards, repeat, reports);
+    BenchGameState<Board>("3x3", repeat, reports);
+    BenchGameState<game::Board4x4>("4x4", repeat, reports);
+    BenchGameState<game::Board7x7>("7x7", repeat, reports);
+    BenchGameState<game::Gomoku>("15x15", repeat, reports);
+}
+
+void BenchElementPool(size_t repeat, std::vector<Report>& reports) {
+    constexpr size_t BLOCK { 1024 };
+    struct Element {
+        uint32_t m_data[4] {};
+    };
+    ElementPool<Element> pool;
+    Recorder recorder { "ElementPool::Acquire", "all" };
+    for(size_t r = 0; r < repeat * 64; r++) {
+        if(pool.Size() + BLOCK > pool.Capacity()) {
+            pool.Reset();
+        }
+        const auto allocations = g_allocations.load(std::memory_order_relaxed);
+        const auto start = Clock::now();
+        for(size_t i = 0; i < BLOCK; i++) {
+            pool.Acquire()->m_data[0] = static_cast<uint32_t>(i);
+        }
+        const auto duration = Clock::now() - start;
+        recorder.Add(duration, g_allocations.load(std::memory_order_relaxed) - allocations, 0, 0, BLOCK);
+    }
+    reports.push_back(recorder.Finish());
+}
+
+void PrintJson(const std::vector<Report>& reports) {
+    std::cout << "[\n";
+    for(size_t i = 0; i < reports.size(); i++) {
+        const auto& report = reports[i];
+        std::cout << "  { \"name\": \"" << report.m_name << "\""
+            << ", \"corpus\": \"" << report.m_corpus << "\""
+            << ", \"calls\": " << report.m_calls
+            << ", \"mean_ns\": " << report.m_mean
+            << ", \"p50_ns\": " << report.m_p50
+            << ", \"p90_ns\": " << report.m_p90
+            << ", \"p99_ns\": " << report.m_p99
+            << ", \"nodes_per_s\": " << report.m_nodesPerSecond
+            << ", \"playouts_per_s\": " << report.m_playoutsPerSecond
+            << ", \"allocations_per_call\": " << report.m_allocationsPerCall
+            << ", \"iteration_limit\": " << report.m_iterationLimit
+            << ", \"optimal_rate\": " << report.m_optimalRate
+            << " }" << (i + 1 < reports.size()? ",\n" : "\n");
+    }
+    std::cout << "]\n";
+}
+
+void PrintCsv(const std::vector<Report>& reports) {
+    std::cout << "name,corpus,calls,mean_ns,p50_ns,p90_ns,p99_ns,nodes_per_s,playouts_per_s,allocations_per_call,iteration_limit,optimal_rate\n";
+    for(const auto& report: reports) {
+        std::cout << report.m_name << ',' << report.m_corpus << ',' << report.m_calls
+            << ',' << report.m_mean << ',' << report.m_p50 << ',' << report.m_p90 << ',' << report.m_p99
+            << ',' << report.m_nodesPerSecond << ',' << report.m_playoutsPerSecond
+            << ',' << report.m_allocationsPerCall
+            << ',' << report.m_iterationLimit << ',' << report.m_optimalRate << '\n';
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    using namespace solution;
+
+    bool csv { false };
+    size_t repeat { 5 };
+    for(int i = 1; i < argc; i++) {
+        const std::string arg { argv[i] };
+        if(arg == "--format" && i + 1 < argc) {
+            csv = std::string { argv[++i] } == "csv";
+        }
+        else if(arg == "--repeat" && i + 1 < argc) {
+            repeat = std::max<size_t>(1, std::stoul(argv[++i]));
+        }
+        else {
+            std::cerr << "Usage: " << argv[0] << " [--format json|csv] [--repeat N]\n";
+            return 1;
+        }
+    }
+
+    std::vector<Report> reports;
+    const auto expanded = [](const auto& solver) {
+        return std::pair<uint64_t, uint64_t> { solver.Expanded(), 0 };
+    };
+    BenchSolver<Minimax>("Minimax"
+        , [](uint8_t player) { return std::make_unique<Minimax>(player); }
+        , expanded, repeat, reports);
+    BenchSolver<AlphaBettaMinimax>("AlphaBettaMinimax"
+        , [](uint8_t player) { return std::make_unique<AlphaBettaMinimax>(player); }
+        , expanded, repeat, reports);
+    BenchSolver<Negamax>("Negamax"
+        , [](uint8_t player) { return std::make_unique<Negamax>(player); }
+        , expanded, repeat, reports);
+    // the iteration limit (not time) stops the search so the work is the same on any machine
+    BenchSolver<MCTS>("MCTS"
+        , [](uint8_t player) { return std::make_unique<MCTS>(1'000'000'000, 5'000, 100'000, player); }
+        , [](const MCTS& solver) { return std::pair<uint64_t, uint64_t> { 0, solver.Playouts() }; }
+        , repeat, reports);
+    BenchOracle("MCTS oracle", 0, false, repeat, reports);
+    BenchOracle("MCTS+RAVE oracle", 10, false, repeat, reports);
+    BenchOracle("MCTS symmetric oracle", 0, true, repeat, reports);
+    BenchGameState(repeat, reports);
+    BenchElementPool(repeat, reports);
+
+    if(csv) {
+        PrintCsv(reports);
+    }
+    else {
+        PrintJson(reports);
+    }
+    return 0;
+}
@@ -1,72 +1,104 @@
 #include "Board.hpp"
+#include "Random.hpp"
 
-namespace game {
-    std::ostream& operator<<(std::ostream& os, Board board) {
-        for(size_t i = 0; i < Board::SIZE; i++) {
-            const auto cell = board.at(i / Board::ROWS, i % Board::COLS);
-            os << (cell == Board::Cell::X ? 'x' : 
-                (cell == Board::Cell::O? 'o' : '.'));
-            os << (i % Board::COLS == Board::COLS - 1U? "\n" : " | ");
-        }
-        return os;
-    }
-
-    std::pair<Board::State, Board::Cell> GetGameState(Board board) noexcept {
-        int freeSpaceCounter { 0 };
-        int x { 0 }, o { 0 };
-
-        // any column 
-        for(size_t row = 0; row < Board::ROWS; row++) {
-            x = o = 0;
-            for(size_t col = 0; col < Board::COLS; col++) {
-                auto value { board.at(row, col) };
-                x += value == Board::Cell::X;
-                o += value == Board::Cell::O;
-                freeSpaceCounter += value == Board::Cell::FREE;
-            }
-            if(x == 3) return { Board::State::WIN, Board::Cell::X };
-            else if(o == 3) return { Board::State::WIN, Board::Cell::O };
-        }
+namespace {
 
-        // any row 
-        for(size_t col = 0; col < Board::COLS; col++) {
-            x = o = 0;
-            for(size_t row = 0; row < Board::ROWS; row++) {
-                auto value { board.at(row, col) };
-                x += value == Board::Cell::X;
-                o += value == Board::Cell::O;
-            }
-            if(x == 3) return { Board::State::WIN, Board::Cell::X };
-            else if(o == 3) return { Board::State::WIN, Board::Cell::O };
-        }
+// the lines of the m,n,k boards and their symmetries
+template<class Board_t>
+void TestBoards() {
+    using game::Cell;
+    using game::State;
+    constexpr auto ROWS = Board_t::ROWS;
+    constexpr auto COLS = Board_t::COLS;
+    constexpr auto LINE = Board_t::LINE;
 
-        // main diag 
-        x = o = 0;
-        for(size_t i = 0; i < game::Board::ROWS; i++) {
-            const auto value = board.at(i, i);
-            x += value == Board::Cell::X;
-            o += value == Board::Cell::O;
+    // the lines ending at the last row and column
+    const std::pair<size_t, size_t> directions[] = { { 0, 1 }, { 1, 0 }, { 1, 1 } };
+    for(const auto& [dRow, dCol]: directions) {
+        Board_t board;
+        for(size_t i = 0; i < LINE; i++) {
+            const auto row = dRow? ROWS - LINE + i : ROWS - 1;
+            const auto col = dCol? COLS - LINE + i : COLS - 1;
+            assert(game::GetGameState(board).first == State::ONGOING && "The line isn't complete yet");
+            board.assign(row, col, Cell::O);
         }
-        if(x == 3) return { Board::State::WIN, Board::Cell::X };
-        else if(o == 3) return { Board::State::WIN, Board::Cell::O };
-
-        // Points from the other diagonal
-        x = o = 0;
-        for(size_t i = 0; i < game::Board::ROWS; i++) {
-            const auto value = board.at(i, game::Board::ROWS - i - 1);
-            x += value == Board::Cell::X;
-            o += value == Board::Cell::O;
+        assert(game::GetGameState(board) == std::make_pair(State::WIN, Cell::O) && "Failed to detect the line");
+    }
+    Board_t board;
+    for(size_t i = 0; i < LINE; i++) {
+        board.assign(i, LINE - 1 - i, Cell::X);
+    }
+    assert(game::GetGameState(board) == std::make_pair(State::WIN, Cell::X) && "Failed to detect anti-diagonal");
+
+    // the cells at the end of a row and at the start of the next one don't make a line
+    board = Board_t{};
+    for(size_t i = 0; i < LINE; i++) {
+        board.assign(COLS - LINE / 2 + i, Cell::X);
+    }
+    assert(game::GetGameState(board).first == State::ONGOING && "The line must not wrap around the edge");
+
+    // the lowest and the highest cells are in different words of the wide masks
+    board = Board_t{};
+    board.assign(0, Cell::X);
+    board.assign(Board_t::SIZE - 1, Cell::O);
+    assert(board.at(0) == Cell::X && board.at(Board_t::SIZE - 1) == Cell::O && "Wrong cells");
+    assert(game::details::LowestBit(board.marks(Cell::O)) == Board_t::SIZE - 1 && "Wrong lowest bit");
+    assert(game::Cells { board.freeCells() }.size() == Board_t::SIZE - 2 && "Wrong number of free cells");
+    assert(game::details::CountBits(board.freeCells() & ~game::details::Bit<typename Board_t::Mask_t>(1)) == Board_t::SIZE - 3
+        && "Wrong number of set bits");
+    board.clear(Board_t::SIZE - 1);
+    assert(board == Board_t{}.assigned(0, Cell::X) && "Failed to clear the cell");
+    board.assign(COLS + 1, Cell::O);
+
+    // symmetries
+    for(size_t s = 0; s < Board_t::SYMMETRIES; s++) {
+        [[maybe_unused]] const auto transformed = game::Transform(board, s);
+        assert(game::Canonical(transformed).first == game::Canonical(board).first
+            && "Symmetric boards must share the canonical form");
+        for(size_t i = 0; i < Board_t::SIZE; i++) {
+            [[maybe_unused]] const auto cell = game::TransformCell<Board_t>(i, s);
+            assert(game::TransformCell<Board_t>(cell, game::InverseSymmetry(s)) == i && "Wrong inverse symmetry");
+            assert(transformed.at(cell) == board.at(i) && "Wrong board transformation");
         }
-        if(x == 3) return { Board::State::WIN, Board::Cell::X };
-        else if(o == 3) return { Board::State::WIN, Board::Cell::O };
+    }
 
-        return (freeSpaceCounter? 
-            std::make_pair(Board::State::ONGOING, Board::Cell::X) :  // second part of pair doesn't matter
-            std::make_pair(Board::State::DRAW, Board::Cell::X) // second part of pair doesn't matter
-        );
+    // one move of each group of symmetric moves: the orbits of the cells on the empty square board
+    [[maybe_unused]] constexpr auto HALF = (COLS + 1) / 2;
+    assert(game::details::CountBits(game::UniqueMoves(Board_t{})) == (ROWS == COLS? HALF * (HALF + 1) / 2 : Board_t::SIZE)
+        && "Wrong number of unique moves of the empty board");
+    // the board symmetric only by the main diagonal: the cells below it are the same as above
+    board = Board_t{};
+    board.assign(0, Cell::X);
+    board.assign(COLS + 1, Cell::O);
+    board.assign(2 * COLS + 2, Cell::X);
+    if constexpr (ROWS == COLS) {
+        assert(game::details::CountBits(game::UniqueMoves(board)) == (Board_t::SIZE - ROWS) / 2 + ROWS - 3
+            && "The cells below the diagonal must be skipped");
+    }
+}
+
+// the incremental state equals the state of the whole board all along random games
+template<class Board_t>
+void TestLastMove() {
+    solution::Xorshift32 random { 7u };
+    for(size_t i = 0; i < 100; i++) {
+        Board_t board;
+        auto player = game::Cell::X;
+        for(auto state = game::State::ONGOING; state == game::State::ONGOING;) {
+            const auto cell = solution::RandomCell(game::Cells { board.freeCells() }, random);
+            board.assign(cell, player);
+            const auto incremental = game::GetGameState(board, cell);
+            [[maybe_unused]] const auto full = game::GetGameState(board);
+            assert(incremental.first == full.first && (full.first != game::State::WIN || incremental.second == full.second)
+                && "The incremental state must match the whole board");
+            state = incremental.first;
+            player = player == game::Cell::X? game::Cell::O : game::Cell::X;
+        }
     }
 }
 
+} // namespace
+
 void TestBoard() {
     using game::Board;
     std::cerr << "Test the board...\n";
@@ -109,20 +141,83 @@ void TestBoard() {
     }
 
     // finished
-    for(size_t i = 0; i < Board::Details::SIZE; i++) {
+    for(size_t i = 0; i < Board::SIZE; i++) {
        board.clear(i / 3u, i % 3); 
     }
-    for(size_t i = 0; i < Board::Details::SIZE; i+=2) {
+    for(size_t i = 0; i < Board::SIZE; i+=2) {
         board.assign(i/3u, i%3u, Board::Cell::X);
     }
-    for(size_t i = 1; i < Board::Details::SIZE; i+=2) {
+    for(size_t i = 1; i < Board::SIZE; i+=2) {
         board.assign(i/3u, i%3u, Board::Cell::O);
     }
     assert(board.finished() && "Failed finished board check");
+    // x | o | x
+    // o | x | o
+    // x | o | x
+    assert(game::GetGameState(board) == std::make_pair(Board::State::WIN, Board::Cell::X) 
+        && "Failed to detect diagonal win");
     board.clear(1u,1u);
     assert(!board.finished() && "Failed finished board check");
     board.clear(1u,2u);
     assert(!board.finished() && "Failed finished board check");
+    assert(game::GetGameState(board).first == Board::State::ONGOING && "Failed to detect ongoing game");
+    for(size_t i = 0; i < Board::COLS; i++) {
+        board.assign(1u, i, Board::Cell::O);
+    }
+    assert(game::GetGameState(board) == std::make_pair(Board::State::WIN, Board::Cell::O) 
+        && "Failed to detect row win");
+
+    // symmetries
+    for(size_t s = 0; s < game::details::SYMMETRIES; s++) {
+        [[maybe_unused]] const auto transformed = game::Transform(board, s);
+        assert(game::Canonical(transformed).first.unwrap() == game::Canonical(board).first.unwrap()
+            && "Symmetric boards must share the canonical form");
+        for(size_t i = 0; i < Board::SIZE; i++) {
+            [[maybe_unused]] const auto cell = game::TransformCell(i, s);
+            assert(game::TransformCell(cell, game::InverseSymmetry(s)) == i && "Wrong inverse symmetry");
+            assert(transformed.at(cell / 3, cell % 3) == board.at(i / 3, i % 3) && "Wrong board transformation");
+        }
+    }
+
+    for(size_t s = 0; s < game::details::SYMMETRIES; s++) {
+        for(size_t i = 0; i < Board::SIZE; i++) {
+            assert(game::details::SymmetryCell(Board::COLS, i, s) == game::TransformCell(i, s)
+                && "The symmetries of the square boards must agree with the table");
+        }
+    }
+
+    // free cells
+    static_assert(Board{}.assigned(4, Board::Cell::X).assigned(8, Board::Cell::O).freeCells() == 0b011'101'111
+        , "Wrong mask of free cells");
+    static_assert(Board{}.assigned(4, Board::Cell::X).cleared(4).unwrap() == 0, "Failed to clear the board");
+    size_t freeCount { 0 };
+    for([[maybe_unused]] const auto cell: game::Cells { board.freeCells() }) {
+        assert(board.at(cell) == Board::Cell::FREE && "Cell must be free");
+        freeCount++;
+    }
+    for(size_t i = 0; i < Board::SIZE; i++) {
+        freeCount -= board.at(i) == Board::Cell::FREE;
+    }
+    assert(freeCount == 0 && game::Cells { board.freeCells() }.size() == game::details::CountBits(board.freeCells())
+        && "All free cells must be visited");
+
+    // a corner, an edge and the center; then a corner and an edge around the center
+    static_assert(game::UniqueMoves(Board{}) == 0b000'010'011u, "Wrong unique moves of the empty board");
+    static_assert(game::UniqueMoves(Board{}.assigned(4, Board::Cell::X)) == 0b000'000'011u
+        , "Wrong unique moves after the center");
+
+    TestBoards<game::Board4x4>();
+    TestBoards<game::Board7x7>();
+    TestBoards<game::BasicBoard<10, 10, 5>>();
+    TestBoards<game::Gomoku>();
+    TestLastMove<Board>();
+    TestLastMove<game::Board4x4>();
+    TestLastMove<game::Board7x7>();
+    TestLastMove<game::BasicBoard<10, 10, 5>>();
+    TestLastMove<game::Gomoku>();
 
+    static_assert(std::is_same_v<game::Board4x4::Mask_t, uint32_t> && std::is_same_v<game::Board7x7::Mask_t, uint64_t>
+        && std::is_same_v<game::Gomoku::Mask_t, game::details::Bitset<4>>, "Wrong masks of the boards");
+    static_assert(sizeof(Board) == 4 && sizeof(game::Board4x4) == 4, "The small boards must be packed");
     std::cerr << "Complete test.\n";
 }
@@ -4,40 +4,399 @@
 #include <cassert>
 #include <cstdint>
 #include <cstddef>
+#include <type_traits>
 #include <utility>
 #include <iostream>
+#include <array>
+#include <initializer_list>
 
 // Contain game logic implementation
 namespace game {
 
-    class Board {
+    // marks and states are shared by the boards of all sizes
+    enum class Cell: uint8_t { X = 0, O = 1, FREE = 2 };
+    enum class State: uint8_t { WIN, ONGOING, DRAW };
+
+    namespace details {
+        template<size_t WORDS>
+        class Bitset;
+
+        template<class Mask>
+        struct IsBitset: std::false_type {};
+
+        template<size_t WORDS>
+        struct IsBitset<Bitset<WORDS>>: std::true_type {};
+
+        // index of the lowest set bit, the mask must not be zero
+        template<class Mask>
+        constexpr size_t LowestBit(Mask mask) noexcept {
+            assert(mask && "There is no set bit");
+            if constexpr (IsBitset<Mask>::value) {
+                return mask.LowestBit();
+            }
+            else if constexpr (sizeof(Mask) > sizeof(uint64_t)) {
+                const auto low = static_cast<uint64_t>(mask);
+                return low? LowestBit(low) : 64U + LowestBit(static_cast<uint64_t>(mask >> 64U));
+            }
+            else {
+#if defined(__GNUC__) || defined(__clang__)
+                if constexpr (sizeof(Mask) <= sizeof(uint32_t)) {
+                    return static_cast<size_t>(__builtin_ctz(static_cast<uint32_t>(mask)));
+                }
+                else {
+                    return static_cast<size_t>(__builtin_ctzll(static_cast<uint64_t>(mask)));
+                }
+#else
+                size_t index { 0 };
+                for(; !(mask & 1U); mask >>= 1U) {
+                    index++;
+                }
+                return index;
+#endif
+            }
+        }
+
+        template<class Mask>
+        constexpr size_t CountBits(Mask mask) noexcept {
+            if constexpr (IsBitset<Mask>::value) {
+                return mask.CountBits();
+            }
+            else if constexpr (sizeof(Mask) > sizeof(uint64_t)) {
+                return CountBits(static_cast<uint64_t>(mask)) + CountBits(static_cast<uint64_t>(mask >> 64U));
+            }
+            else {
+#if defined(__GNUC__) || defined(__clang__)
+                if constexpr (sizeof(Mask) <= sizeof(uint32_t)) {
+                    return static_cast<size_t>(__builtin_popcount(static_cast<uint32_t>(mask)));
+                }
+                else {
+                    return static_cast<size_t>(__builtin_popcountll(static_cast<uint64_t>(mask)));
+                }
+#else
+                size_t count { 0 };
+                for(; mask; mask &= mask - 1U) {
+                    count++;
+                }
+                return count;
+#endif
+            }
+        }
+
+        // the mask without its lowest set bit
+        template<class Mask>
+        constexpr Mask ClearLowest(Mask mask) noexcept {
+            if constexpr (IsBitset<Mask>::value) {
+                return mask.ClearLowest();
+            }
+            else {
+                return mask & (mask - 1U);
+            }
+        }
+
+        /**
+         * Mask wider than the integers: `WORDS` 64-bit words, the least significant first.
+         * It has the operators of the unsigned integers the boards use.
+         */
+        template<size_t WORDS>
+        class Bitset {
+        public:
+            constexpr Bitset() noexcept = default;
+
+            constexpr explicit Bitset(uint64_t low) noexcept
+                : m_words { low }
+            {}
+
+            constexpr explicit operator bool() const noexcept {
+                for(const auto word: m_words) {
+                    if(word) {
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            constexpr Bitset operator~() const noexcept {
+                Bitset result;
+                for(size_t i = 0; i < WORDS; i++) {
+                    result.m_words[i] = ~m_words[i];
+                }
+                return result;
+            }
+
+            constexpr Bitset& operator&=(const Bitset& other) noexcept {
+                for(size_t i = 0; i < WORDS; i++) {
+                    m_words[i] &= other.m_words[i];
+                }
+                return *this;
+            }
+
+            constexpr Bitset& operator|=(const Bitset& other) noexcept {
+                for(size_t i = 0; i < WORDS; i++) {
+                    m_words[i] |= other.m_words[i];
+                }
+                return *this;
+            }
+
+            constexpr Bitset& operator^=(const Bitset& other) noexcept {
+                for(size_t i = 0; i < WORDS; i++) {
+                    m_words[i] ^= other.m_words[i];
+                }
+                return *this;
+            }
+
+            constexpr Bitset operator<<(size_t shift) const noexcept {
+                Bitset result;
+                const auto words = shift / 64U;
+                const auto bits = shift % 64U;
+                for(size_t i = words; i < WORDS; i++) {
+                    result.m_words[i] = m_words[i - words] << bits;
+                    if(bits && i > words) {
+                        result.m_words[i] |= m_words[i - words - 1] >> (64U - bits);
+                    }
+                }
+                return result;
+            }
+
+            constexpr Bitset operator>>(size_t shift) const noexcept {
+                Bitset result;
+                const auto words = shift / 64U;
+                const auto bits = shift % 64U;
+                for(size_t i = 0; i + words < WORDS; i++) {
+                    result.m_words[i] = m_words[i + words] >> bits;
+                    if(bits && i + words + 1 < WORDS) {
+                        result.m_words[i] |= m_words[i + words + 1] << (64U - bits);
+                    }
+                }
+                return result;
+            }
+
+            friend constexpr Bitset operator&(Bitset lhs, const Bitset& rhs) noexcept {
+                return lhs &= rhs;
+            }
+
+            friend constexpr Bitset operator|(Bitset lhs, const Bitset& rhs) noexcept {
+                return lhs |= rhs;
+            }
+
+            friend constexpr Bitset operator^(Bitset lhs, const Bitset& rhs) noexcept {
+                return lhs ^= rhs;
+            }
+
+            friend constexpr bool operator==(const Bitset& lhs, const Bitset& rhs) noexcept {
+                for(size_t i = 0; i < WORDS; i++) {
+                    if(lhs.m_words[i] != rhs.m_words[i]) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            friend constexpr bool operator!=(const Bitset& lhs, const Bitset& rhs) noexcept {
+                return !(lhs == rhs);
+            }
+
+            // compared as numbers
+            friend constexpr bool operator<(const Bitset& lhs, const Bitset& rhs) noexcept {
+                for(size_t i = WORDS; i-- > 0;) {
+                    if(lhs.m_words[i] != rhs.m_words[i]) {
+                        return lhs.m_words[i] < rhs.m_words[i];
+                    }
+                }
+                return false;
+            }
+
+            constexpr size_t LowestBit() const noexcept {
+                size_t i { 0 };
+                for(; !m_words[i]; i++) {}
+                return 64U * i + details::LowestBit(m_words[i]);
+            }
+
+            constexpr size_t CountBits() const noexcept {
+                size_t count { 0 };
+                for(const auto word: m_words) {
+                    count += details::CountBits(word);
+                }
+                return count;
+            }
+
+            constexpr Bitset ClearLowest() const noexcept {
+                auto result { *this };
+                size_t i { 0 };
+                for(; i < WORDS && !result.m_words[i]; i++) {}
+                if(i < WORDS) {
+                    result.m_words[i] &= result.m_words[i] - 1U;
+                }
+                return result;
+            }
+
+            constexpr uint64_t Word(size_t index) const noexcept {
+                return m_words[index];
+            }
+
+        private:
+            uint64_t m_words[WORDS] {};
+        };
+
+#ifdef __SIZEOF_INT128__
+        using Wide_t = unsigned __int128;
+#else
+        using Wide_t = Bitset<2>;
+#endif
+
+        // the narrowest mask of `BITS` bits: 32, 64, 128-bit integer or several words
+        template<size_t BITS>
+        using Mask_t = std::conditional_t<BITS <= 32U, uint32_t,
+            std::conditional_t<BITS <= 64U, uint64_t,
+            std::conditional_t<BITS <= 128U, Wide_t, Bitset<(BITS + 63U) / 64U>>>>;
+
+        template<class Mask>
+        constexpr Mask Bit(size_t index) noexcept {
+            return Mask { 1U } << index;
+        }
+
+        template<class Mask>
+        constexpr bool HasBit(const Mask& mask, size_t index) noexcept {
+            if constexpr (IsBitset<Mask>::value) {
+                // only the word of the bit is shifted
+                return (mask.Word(index / 64U) >> (index % 64U)) & 1U;
+            }
+            else {
+                return static_cast<bool>((mask >> index) & Mask { 1U });
+            }
+        }
+
+        // `count` lowest bits are set
+        template<class Mask>
+        constexpr Mask LowBits(size_t count) noexcept {
+            return count? ~Mask{} >> (8U * sizeof(Mask) - count) : Mask{};
+        }
+
+        // 64-bit digest of the mask
+        template<class Mask>
+        constexpr uint64_t Fold(Mask mask) noexcept {
+            if constexpr (IsBitset<Mask>::value) {
+                uint64_t result { 0 };
+                for(size_t i = 0; i < sizeof(Mask) / sizeof(uint64_t); i++) {
+                    result = (result ^ mask.Word(i)) * 0x100000001B3ull;
+                }
+                return result;
+            }
+            else if constexpr (sizeof(Mask) > sizeof(uint64_t)) {
+                return static_cast<uint64_t>(mask) ^ static_cast<uint64_t>(mask >> 64U) * 0x100000001B3ull;
+            }
+            else {
+                return static_cast<uint64_t>(mask);
+            }
+        }
+    }
+
+    /**
+     * Board of the m,n,k-game: `Rows` x `Cols` cells, `Line` marks in a row (horizontally,
+     * vertically or diagonally) win. The marks of each player are a bitboard where the bit
+     * `row * Cols + col` is the cell; its type is chosen at compile time by the number of cells:
+     * 32, 64 or 128-bit integer or several 64-bit words (see `details::Mask_t`).
+     */
+    template<size_t Rows, size_t Cols, size_t Line>
+    class BasicBoard {
     public:
-        enum Details: size_t { ROWS = 3, COLS = 3, SIZE = 9 };
-        enum class Cell: uint8_t { X = 0, O = 1, FREE = 2 };
-        enum class State: uint8_t { WIN, ONGOING, DRAW };
-        // TODO: add enums to mark a player: 'o', 'x'
+        static constexpr size_t ROWS { Rows };
+        static constexpr size_t COLS { Cols };
+        static constexpr size_t SIZE { Rows * Cols };
+        // number of marks in a row to win
+        static constexpr size_t LINE { Line };
+        // the square board has 8 symmetries (the dihedral group), the others use only the identity
+        static constexpr size_t SYMMETRIES { Rows == Cols? 8U : 1U };
+
+        static_assert(LINE > 0 && LINE <= (ROWS > COLS? ROWS : COLS), "The line must fit into the board");
+        // the solvers keep cells in bytes
+        static_assert(SIZE < 256U, "The board is too big");
+
+        using Cell = game::Cell;
+        using State = game::State;
+        // marks of one player (or the free cells): the i-th bit is the cell `i`
+        using Mask_t = details::Mask_t<SIZE>;
+
+        // all cells of the board
+        static constexpr Mask_t FULL { details::LowBits<Mask_t>(SIZE) };
+
+        constexpr BasicBoard() noexcept = default;
+
+        // restore the board from the value returned by `unwrap()`
+        constexpr explicit BasicBoard(size_t desk) noexcept
+            : m_marks { static_cast<Storage_t>(desk) }
+        {
+            static_assert(PACKED, "The board doesn't fit into an integer");
+        }
 
         constexpr Cell at(size_t row, size_t col) const noexcept {
-            const auto bitIndex = row * Details::ROWS + col;
-            return  (m_desk & (1U << bitIndex)) > 0U? Cell::X: 
-                    (m_desk & (1U << (bitIndex + Details::SIZE))) > 0U? Cell::O : Cell::FREE;
+            return this->at(row * COLS + col);
         }
 
-        // TODO: add constexpr assignment and clear methods which will return the new board 
-        // without modifying this one
+        // @param bitIndex index of the cell: row * COLS + col
+        constexpr Cell at(size_t bitIndex) const noexcept {
+            return  details::HasBit(this->marks(Cell::X), bitIndex)? Cell::X :
+                    details::HasBit(this->marks(Cell::O), bitIndex)? Cell::O : Cell::FREE;
+        }
+
+        // @return mask of the player's cells: 'x' or 'o'
+        constexpr Mask_t marks(Cell player) const noexcept {
+            if constexpr (PACKED) {
+                return static_cast<Mask_t>(m_marks[0] >> (SIZE * static_cast<size_t>(player))) & FULL;
+            }
+            else {
+                return m_marks[static_cast<size_t>(player)];
+            }
+        }
+
+        // @return mask of the free cells: i-th bit is set when the cell `i` is free
+        constexpr Mask_t freeCells() const noexcept {
+            return ~(this->marks(Cell::X) | this->marks(Cell::O)) & FULL;
+        }
 
-        void assign(size_t row, size_t col, Cell value) noexcept {
-            const auto bitIndex = row * Details::ROWS + col;
-            m_desk |= value == Cell::X? (1U << bitIndex) : 
-                      value == Cell::O? (1U << (bitIndex + Details::SIZE)): 0U;
+        constexpr void assign(size_t row, size_t col, Cell value) noexcept {
+            this->assign(row * COLS + col, value);
         }
 
-        void clear(size_t row, size_t col) noexcept {
-            const auto bitIndex = row * Details::ROWS + col;
-            // clear 'x'
-            m_desk &= ~(1U << bitIndex);
-            // clear 'o'
-            m_desk &= ~(1U << (bitIndex + Details::SIZE));
+        constexpr void assign(size_t bitIndex, Cell value) noexcept {
+            if(value == Cell::FREE) {
+                return;
+            }
+            if constexpr (PACKED) {
+                m_marks[0] |= Storage_t { 1U } << (bitIndex + SIZE * static_cast<size_t>(value));
+            }
+            else {
+                m_marks[static_cast<size_t>(value)] |= details::Bit<Mask_t>(bitIndex);
+            }
+        }
+
+        constexpr void clear(size_t row, size_t col) noexcept {
+            this->clear(row * COLS + col);
+        }
+
+        constexpr void clear(size_t bitIndex) noexcept {
+            // clear 'x' and 'o'
+            if constexpr (PACKED) {
+                m_marks[0] &= ~((Storage_t { 1U } << bitIndex) | (Storage_t { 1U } << (bitIndex + SIZE)));
+            }
+            else {
+                const auto mask = ~details::Bit<Mask_t>(bitIndex);
+                m_marks[0] &= mask;
+                m_marks[1] &= mask;
+            }
+        }
+
+        // @return the new board with the cell assigned, this one isn't modified
+        constexpr BasicBoard assigned(size_t bitIndex, Cell value) const noexcept {
+            auto board { *this };
+            board.assign(bitIndex, value);
+            return board;
+        }
+
+        // @return the new board with the cell cleared, this one isn't modified
+        constexpr BasicBoard cleared(size_t bitIndex) const noexcept {
+            auto board { *this };
+            board.clear(bitIndex);
+            return board;
         }
 
         /**
@@ -45,42 +404,456 @@ namespace game {
          * returns true if the game is finished, false - ongoing!
          */
         constexpr bool finished() const noexcept {
-            const size_t players[2] = {
-                // clear the bits used by second player - 'o', 
-                // leave the bits of player - 'x' untouched
-                m_desk & (~((~(1U << Details::SIZE)) << Details::SIZE)),  // 'x'
-                m_desk >> Details::SIZE             // 'o'
-            };
-            constexpr auto fullBoard { 0b111111111 };
-            
-            assert(players[0] <= fullBoard && "Wrong bit conversation");
-            assert(players[1] <= fullBoard && "Wrong bit conversation");
-            assert(((players[0] & players[1]) == 0U) && "Logic error: moves overlaped");
-            
-            return (players[0]|players[1]) == fullBoard;
-        }
-
-        // return an unsigned integer which represent the board
+            assert(!((this->marks(Cell::X) | this->marks(Cell::O)) & ~FULL) && "Wrong bit conversation");
+            assert(!(this->marks(Cell::X) & this->marks(Cell::O)) && "Logic error: moves overlaped");
+            return !this->freeCells();
+        }
+
+        /**
+         * @return an unsigned integer which represent the board:
+         * [0 ... SIZE) - 'x', [SIZE ... 2 * SIZE) - 'o', available while it fits
+         */
         constexpr size_t unwrap() const noexcept {
-            return m_desk;
+            static_assert(PACKED, "The board doesn't fit into an integer, use `hash()`");
+            return static_cast<size_t>(m_marks[0]);
+        }
+
+        // @return the key for hash tables: `unwrap()` of the small boards
+        constexpr uint64_t hash() const noexcept {
+            if constexpr (PACKED) {
+                return static_cast<uint64_t>(m_marks[0]);
+            }
+            else {
+                return details::Fold(this->marks(Cell::X)) * 0x9E3779B97F4A7C15ull ^ details::Fold(this->marks(Cell::O));
+            }
+        }
+
+        friend constexpr bool operator==(const BasicBoard& lhs, const BasicBoard& rhs) noexcept {
+            if constexpr (PACKED) {
+                return lhs.m_marks[0] == rhs.m_marks[0];
+            }
+            else {
+                return lhs.m_marks[0] == rhs.m_marks[0] && lhs.m_marks[1] == rhs.m_marks[1];
+            }
         }
 
-        friend std::ostream& operator<<(std::ostream&, Board board);
+        friend constexpr bool operator!=(const BasicBoard& lhs, const BasicBoard& rhs) noexcept {
+            return !(lhs == rhs);
+        }
+
+        // the order of `unwrap()` values: 'o' is compared first
+        friend constexpr bool operator<(const BasicBoard& lhs, const BasicBoard& rhs) noexcept {
+            if constexpr (PACKED) {
+                return lhs.m_marks[0] < rhs.m_marks[0];
+            }
+            const auto lhsO = lhs.marks(Cell::O);
+            const auto rhsO = rhs.marks(Cell::O);
+            return lhsO < rhsO || (lhsO == rhsO && lhs.marks(Cell::X) < rhs.marks(Cell::X));
+        }
 
     private:
-        // `size_t` is at least 32bit value, so let assign it's bits a specific value:
-        // from lsb
-        // [0 ... 8]   - indicates whether the cell at i-th place is 'x' or not
-        // [9 ... 17]  - indicates whether the cell at i-th place is 'o' or not
-        // [18 ... 32 (64)] - unspecified
-        size_t m_desk { 0U };
+        // both players fit into one word: 'x' - [0 ... SIZE), 'o' - [SIZE ... 2 * SIZE),
+        // the boards up to 4x4 take 4 bytes
+        static constexpr bool PACKED { 2U * SIZE <= 64U };
+        using Storage_t = std::conditional_t<PACKED
+            , std::conditional_t<2U * SIZE <= 32U, uint32_t, uint64_t>
+            , Mask_t>;
+
+        // packed: [0] - cells of both players, otherwise: [0] - cells of 'x', [1] - cells of 'o'
+        Storage_t m_marks[PACKED? 1U : 2U] {};
     };
 
-    std::ostream& operator<<(std::ostream& os, Board board);
-    
-    std::pair<Board::State, Board::Cell> GetGameState(Board board) noexcept;
+    template<size_t Rows, size_t Cols, size_t Line>
+    std::ostream& operator<<(std::ostream& os, BasicBoard<Rows, Cols, Line> board) {
+        for(size_t i = 0; i < board.SIZE; i++) {
+            const auto cell = board.at(i);
+            os << (cell == Cell::X ? 'x' :
+                (cell == Cell::O? 'o' : '.'));
+            os << (i % Cols == Cols - 1U? "\n" : " | ");
+        }
+        return os;
+    }
+
+    // tic-tac-toe
+    using Board = BasicBoard<3, 3, 3>;
+    // the boards the solvers are built for besides tic-tac-toe:
+    // 4x4 with 4 in a row, 7x7 with 4 in a row and gomoku (15x15 with 5 in a row)
+    using Board4x4 = BasicBoard<4, 4, 4>;
+    using Board7x7 = BasicBoard<7, 7, 4>;
+    using Gomoku = BasicBoard<15, 15, 5>;
+
+    namespace details {
+        // 9-bit masks of all lines: 3 rows, 3 columns and 2 diagonals
+        constexpr uint16_t LINES[] = {
+            0b000'000'111, 0b000'111'000, 0b111'000'000,
+            0b001'001'001, 0b010'010'010, 0b100'100'100,
+            0b100'010'001, 0b001'010'100
+        };
+
+        // full board for one player, i.e. bits [0 ... 8]
+        constexpr size_t PLAYER_MASK { (1U << Board::SIZE) - 1U };
+
+        // i-th value indicates whether the 9-bit mask `i` of one player
+        // contains at least one complete line
+        constexpr std::array<bool, PLAYER_MASK + 1U> MakeWinTable() noexcept {
+            std::array<bool, PLAYER_MASK + 1U> table {};
+            for(size_t mask = 0; mask <= PLAYER_MASK; mask++) {
+                for(auto line: LINES) {
+                    table[mask] = table[mask] || (mask & line) == line;
+                }
+            }
+            return table;
+        }
+
+        inline constexpr auto WIN_TABLE { MakeWinTable() };
+
+        // directions of the lines: along the row, the column, the diagonal and the anti-diagonal
+        constexpr size_t DIRECTIONS { 4 };
+
+        // [direction] - cells where a line can start: the whole line fits into the board
+        template<class Board_t>
+        constexpr std::array<typename Board_t::Mask_t, DIRECTIONS> MakeLineStarts() noexcept {
+            using Mask = typename Board_t::Mask_t;
+            std::array<Mask, DIRECTIONS> starts {};
+            constexpr auto last { Board_t::LINE - 1U };
+            for(size_t row = 0; row < Board_t::ROWS; row++) {
+                for(size_t col = 0; col < Board_t::COLS; col++) {
+                    const auto cell = Bit<Mask>(row * Board_t::COLS + col);
+                    const bool fits[DIRECTIONS] = {
+                        col + last < Board_t::COLS,
+                        row + last < Board_t::ROWS,
+                        row + last < Board_t::ROWS && col + last < Board_t::COLS,
+                        row + last < Board_t::ROWS && col >= last
+                    };
+                    for(size_t d = 0; d < DIRECTIONS; d++) {
+                        starts[d] |= fits[d]? cell : Mask{};
+                    }
+                }
+            }
+            return starts;
+        }
+
+        template<class Board_t>
+        inline constexpr auto LINE_STARTS { MakeLineStarts<Board_t>() };
+
+        /**
+         * Shift-and-mask line test: the marks shifted by the step of the direction
+         * (next cell in the row, column or diagonal) are intersected `LINE - 1` times,
+         * the set bits left are the starts of complete lines. Only the cells where
+         * a line fits can start it, so lines never wrap around the edges.
+         */
+        template<class Board_t>
+        constexpr bool HasLine(typename Board_t::Mask_t marks) noexcept {
+            constexpr size_t STEPS[DIRECTIONS] = { 1U, Board_t::COLS, Board_t::COLS + 1U, Board_t::COLS - 1U };
+            for(size_t d = 0; d < DIRECTIONS; d++) {
+                auto line = marks & LINE_STARTS<Board_t>[d];
+                for(size_t i = 1; i < Board_t::LINE && line; i++) {
+                    line &= marks >> (i * STEPS[d]);
+                }
+                if(line) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // [cell][direction][0] - number of the cells after the cell in the direction within the board
+        // (at most `LINE - 1`), [1] - before it
+        template<class Board_t>
+        using LineReach_t = std::array<std::array<std::array<uint8_t, 2>, DIRECTIONS>, Board_t::SIZE>;
+
+        template<class Board_t>
+        constexpr LineReach_t<Board_t> MakeLineReach() noexcept {
+            LineReach_t<Board_t> reach {};
+            constexpr int ROW_STEPS[DIRECTIONS] = { 0, 1, 1, 1 };
+            constexpr int COL_STEPS[DIRECTIONS] = { 1, 0, 1, -1 };
+            constexpr auto ROWS = static_cast<int>(Board_t::ROWS);
+            constexpr auto COLS = static_cast<int>(Board_t::COLS);
+            for(int row = 0; row < ROWS; row++) {
+                for(int col = 0; col < COLS; col++) {
+                    for(size_t d = 0; d < DIRECTIONS; d++) {
+                        for(size_t side = 0; side < 2; side++) {
+                            const auto sign = side? -1 : 1;
+                            uint8_t count { 0 };
+                            for(auto r = row + sign * ROW_STEPS[d], c = col + sign * COL_STEPS[d];
+                                count + 1U < Board_t::LINE && r >= 0 && r < ROWS && c >= 0 && c < COLS;
+                                r += sign * ROW_STEPS[d], c += sign * COL_STEPS[d]
+                            ) {
+                                count++;
+                            }
+                            reach[static_cast<size_t>(row * COLS + col)][d][side] = count;
+                        }
+                    }
+                }
+            }
+            return reach;
+        }
+
+        template<class Board_t>
+        inline constexpr auto LINE_REACH { MakeLineReach<Board_t>() };
+
+        /**
+         * Line test through the cell: the marks are counted from the cell both ways
+         * in each direction, at most `LINE - 1` cells each way, so the cost doesn't
+         * depend on the size of the board
+         */
+        template<class Board_t>
+        constexpr bool HasLineThrough(typename Board_t::Mask_t marks, size_t cell) noexcept {
+            constexpr size_t STEPS[DIRECTIONS] = { 1U, Board_t::COLS, Board_t::COLS + 1U, Board_t::COLS - 1U };
+            const auto& reach = LINE_REACH<Board_t>[cell];
+            for(size_t d = 0; d < DIRECTIONS; d++) {
+                size_t count { 1 };
+                for(size_t k = 1; k <= reach[d][0] && HasBit(marks, cell + k * STEPS[d]); k++) {
+                    count++;
+                }
+                for(size_t k = 1; k <= reach[d][1] && HasBit(marks, cell - k * STEPS[d]); k++) {
+                    count++;
+                }
+                if(count >= Board_t::LINE) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // number of the board symmetries (dihedral group): 4 rotations and 4 reflections
+        constexpr size_t SYMMETRIES { 8 };
+
+        // SYMMETRY_CELLS[s][i] - the cell where the i-th cell moves under the symmetry `s`:
+        // identity, rotations by 90, 180, 270 degrees (clockwise),
+        // reflections: horizontal, vertical, main and anti diagonal
+        constexpr uint8_t SYMMETRY_CELLS[SYMMETRIES][Board::SIZE] = {
+            { 0, 1, 2, 3, 4, 5, 6, 7, 8 },
+            { 2, 5, 8, 1, 4, 7, 0, 3, 6 },
+            { 8, 7, 6, 5, 4, 3, 2, 1, 0 },
+            { 6, 3, 0, 7, 4, 1, 8, 5, 2 },
+            { 2, 1, 0, 5, 4, 3, 8, 7, 6 },
+            { 6, 7, 8, 3, 4, 5, 0, 1, 2 },
+            { 0, 3, 6, 1, 4, 7, 2, 5, 8 },
+            { 8, 5, 2, 7, 4, 1, 6, 3, 0 }
+        };
+
+        // the same as `SYMMETRY_CELLS` for the square board of any size `side`
+        constexpr size_t SymmetryCell(size_t side, size_t cell, size_t symmetry) noexcept {
+            const auto row = cell / side;
+            const auto col = cell % side;
+            const auto last = side - 1U;
+            switch(symmetry) {
+                case 1: return col * side + last - row;
+                case 2: return (last - row) * side + last - col;
+                case 3: return (last - col) * side + row;
+                case 4: return row * side + last - col;
+                case 5: return (last - row) * side + col;
+                case 6: return col * side + row;
+                case 7: return (last - col) * side + last - row;
+                default: return cell;
+            }
+        }
+
+        // inverse of the i-th symmetry: all of them are involutions except rotations by 90 and 270
+        constexpr uint8_t INVERSE_SYMMETRY[SYMMETRIES] = { 0, 3, 2, 1, 4, 5, 6, 7 };
+
+        using SymmetryTable_t = std::array<std::array<uint16_t, PLAYER_MASK + 1U>, SYMMETRIES>;
+
+        // [s][mask] - the 9-bit mask of one player transformed by the symmetry `s`
+        constexpr SymmetryTable_t MakeSymmetryTable() noexcept {
+            SymmetryTable_t table {};
+            for(size_t s = 0; s < SYMMETRIES; s++) {
+                for(size_t mask = 0; mask <= PLAYER_MASK; mask++) {
+                    for(size_t i = 0; i < Board::SIZE; i++) {
+                        if(mask & (1U << i)) {
+                            table[s][mask] |= static_cast<uint16_t>(1U << SYMMETRY_CELLS[s][i]);
+                        }
+                    }
+                }
+            }
+            return table;
+        }
+
+        inline constexpr auto SYMMETRY_TABLE { MakeSymmetryTable() };
+    }
+
+    /**
+     * Indices of the set bits of the mask from the lowest one, e.g. the free cells:
+     * `for(auto cell: Cells { board.freeCells() })`
+     */
+    template<class Mask>
+    class Cells {
+    public:
+        class Iterator {
+        public:
+            constexpr explicit Iterator(Mask mask) noexcept
+                : m_mask { mask }
+            {}
+
+            constexpr size_t operator*() const noexcept {
+                return details::LowestBit(m_mask);
+            }
+
+            constexpr Iterator& operator++() noexcept {
+                // drop the lowest set bit
+                m_mask = details::ClearLowest(m_mask);
+                return *this;
+            }
+
+            constexpr bool operator!=(Iterator other) const noexcept {
+                return m_mask != other.m_mask;
+            }
+
+        private:
+            Mask m_mask {};
+        };
+
+        constexpr explicit Cells(Mask mask) noexcept
+            : m_mask { mask }
+        {}
+
+        constexpr Iterator begin() const noexcept {
+            return Iterator { m_mask };
+        }
+
+        constexpr Iterator end() const noexcept {
+            return Iterator { Mask{} };
+        }
+
+        constexpr size_t size() const noexcept {
+            return details::CountBits(m_mask);
+        }
+
+    private:
+        Mask m_mask {};
+    };
+
+    /**
+     * Classify the board: tic-tac-toe uses the precomputed win table, so it costs
+     * a couple of loads instead of rescanning all lines, the other boards test
+     * the lines by shifts and masks (see `details::HasLine`).
+     * @return state of the game and the winner (the second value has meaning
+     * only for `State::WIN`)
+     */
+    template<size_t Rows, size_t Cols, size_t Line>
+    constexpr std::pair<State, Cell> GetGameState(BasicBoard<Rows, Cols, Line> board) noexcept {
+        using Board_t = BasicBoard<Rows, Cols, Line>;
+        const auto x = board.marks(Cell::X);
+        const auto o = board.marks(Cell::O);
+        if constexpr (std::is_same_v<Board_t, Board>) {
+            if(details::WIN_TABLE[x]) return { State::WIN, Cell::X };
+            if(details::WIN_TABLE[o]) return { State::WIN, Cell::O };
+        }
+        else {
+            if(details::HasLine<Board_t>(x)) return { State::WIN, Cell::X };
+            if(details::HasLine<Board_t>(o)) return { State::WIN, Cell::O };
+        }
+        // second part of pair doesn't matter
+        return { board.freeCells()? State::ONGOING : State::DRAW, Cell::X };
+    }
+
+    /**
+     * Incremental classification: the board before the move `lastMove` must be ongoing,
+     * so only the lines through the last move can be complete. Tic-tac-toe checks
+     * its win table, the other boards scan only these lines (see `details::HasLineThrough`).
+     * @return the same as `GetGameState(board)`
+     */
+    template<size_t Rows, size_t Cols, size_t Line>
+    constexpr std::pair<State, Cell> GetGameState(BasicBoard<Rows, Cols, Line> board, size_t lastMove) noexcept {
+        using Board_t = BasicBoard<Rows, Cols, Line>;
+        const auto player = board.at(lastMove);
+        assert(player != Cell::FREE && "The last move must be made");
+        const auto marks = board.marks(player);
+        if constexpr (std::is_same_v<Board_t, Board>) {
+            if(details::WIN_TABLE[marks]) return { State::WIN, player };
+        }
+        else {
+            if(details::HasLineThrough<Board_t>(marks, lastMove)) return { State::WIN, player };
+        }
+        // second part of pair doesn't matter
+        return { board.freeCells()? State::ONGOING : State::DRAW, Cell::X };
+    }
+
+    // @return the index of the cell `cell` transformed by the symmetry `symmetry`
+    template<class Board_t = Board>
+    constexpr size_t TransformCell(size_t cell, size_t symmetry) noexcept {
+        assert(symmetry < Board_t::SYMMETRIES && "The board doesn't have the symmetry");
+        if constexpr (std::is_same_v<Board_t, Board>) {
+            return details::SYMMETRY_CELLS[symmetry][cell];
+        }
+        else {
+            return details::SymmetryCell(Board_t::COLS, cell, symmetry);
+        }
+    }
+
+    /**
+     * @return the board transformed by the symmetry `symmetry`,
+     * see `details::SYMMETRY_CELLS` for the order of symmetries
+     */
+    template<size_t Rows, size_t Cols, size_t Line>
+    constexpr BasicBoard<Rows, Cols, Line> Transform(BasicBoard<Rows, Cols, Line> board, size_t symmetry) noexcept {
+        using Board_t = BasicBoard<Rows, Cols, Line>;
+        if constexpr (std::is_same_v<Board_t, Board>) {
+            const auto& table = details::SYMMETRY_TABLE[symmetry];
+            return Board { table[board.marks(Cell::X)] | (static_cast<size_t>(table[board.marks(Cell::O)]) << Board::SIZE) };
+        }
+        else {
+            Board_t result;
+            for(const auto player: { Cell::X, Cell::O }) {
+                for(const auto cell: Cells { board.marks(player) }) {
+                    result.assign(TransformCell<Board_t>(cell, symmetry), player);
+                }
+            }
+            return result;
+        }
+    }
+
+    constexpr size_t InverseSymmetry(size_t symmetry) noexcept {
+        return details::INVERSE_SYMMETRY[symmetry];
+    }
+
+    /**
+     * Canonical form is the least board (see `BasicBoard::operator<`) among
+     * all symmetric boards, so all of them share the same canonical form.
+     * @return the canonical form and the symmetry which maps `board` to it
+     */
+    template<size_t Rows, size_t Cols, size_t Line>
+    constexpr std::pair<BasicBoard<Rows, Cols, Line>, size_t> Canonical(BasicBoard<Rows, Cols, Line> board) noexcept {
+        std::pair<BasicBoard<Rows, Cols, Line>, size_t> result { board, 0 };
+        for(size_t s = 1; s < board.SYMMETRIES; s++) {
+            const auto transformed = Transform(board, s);
+            if(transformed < result.first) {
+                result = { transformed, s };
+            }
+        }
+        return result;
+    }
+
+    /**
+     * The moves mapped to each other by a symmetry preserving the board lead to
+     * symmetric positions, so the least cell of each such group represents all of them
+     * @return the free cells which are the least ones among their symmetric cells
+     */
+    template<size_t Rows, size_t Cols, size_t Line>
+    constexpr typename BasicBoard<Rows, Cols, Line>::Mask_t UniqueMoves(BasicBoard<Rows, Cols, Line> board) noexcept {
+        using Board_t = BasicBoard<Rows, Cols, Line>;
+        using Mask_t = typename Board_t::Mask_t;
+        // symmetries preserving the board except the identity
+        size_t symmetries[Board_t::SYMMETRIES] {};
+        size_t count { 0 };
+        for(size_t s = 1; s < Board_t::SYMMETRIES; s++) {
+            if(Transform(board, s) == board) {
+                symmetries[count++] = s;
+            }
+        }
+        auto moves = board.freeCells();
+        for(size_t k = 0; k < count; k++) {
+            for(const auto cell: Cells { board.freeCells() }) {
+                if(TransformCell<Board_t>(cell, symmetries[k]) < cell) {
+                    moves &= ~details::Bit<Mask_t>(cell);
+                }
+            }
+        }
+        return moves;
+    }
 }
 
 void TestBoard();
 
-#endif // BOARD_HPP
\ No newline at end of file
+#endif // BOARD_HPP
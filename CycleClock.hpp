@@ -0,0 +1,33 @@
+#ifndef CYCLE_CLOCK_HPP_
+#define CYCLE_CLOCK_HPP_
+
+#include <cstdint>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    #include <intrin.h>
+    #define CYCLE_CLOCK_TSC 1
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    #include <x86intrin.h>
+    #define CYCLE_CLOCK_TSC 1
+#else
+    #include <chrono>
+#endif
+
+/**
+ * Monotonic clock with the lowest overhead available:
+ * the time stamp counter on x86 (ticks are cycles of the constant TSC frequency),
+ * nanoseconds of `std::chrono::steady_clock` otherwise.
+ * Ticks are only meant to be compared with each other.
+ */
+struct CycleClock {
+    static uint64_t Now() noexcept {
+#ifdef CYCLE_CLOCK_TSC
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+};
+
+#endif // CYCLE_CLOCK_HPP_
@@ -0,0 +1,128 @@
+#include "Deadline.hpp"
+#include "Minimax.hpp"
+#include "Negamax.hpp"
+#include "MCTS.hpp"
+#include "PerfectPlay.hpp"
+
+#include <cassert>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// the engines take the win in one move on the larger boards before the deadline
+template<class Board_t>
+void TestWinInOne([[maybe_unused]] const Board_t& board, [[maybe_unused]] size_t win, bool exhaustive) {
+    using solution::Deadline;
+    using Game_t = solution::BasicGame<Board_t>;
+    using SolverPointer = std::unique_ptr<solution::BasicSolver<Board_t>>;
+    std::vector<SolverPointer> solvers;
+    solvers.emplace_back(new solution::BasicAlphaBettaMinimax<Game_t> { 1 });
+    solvers.emplace_back(new solution::BasicMCTS<Game_t> { 1'000'000'000, 1'000'000'000, 100'000, 1 });
+    for([[maybe_unused]] auto& solver: solvers) {
+        assert(solver->Run(board, Deadline::After(100'000)) == win && "The solver must take the win");
+    }
+    // these look through all the moves of the root before choosing one,
+    // the deadline would make the test depend on the speed of the build
+    if(exhaustive) {
+        [[maybe_unused]] solution::BasicMinimax<Game_t> minimax { 1 };
+        [[maybe_unused]] solution::BasicNegamax<Game_t> negamax { 1 };
+        assert(minimax.Run(board) == win && "Minimax must take the win");
+        assert(negamax.Run(board) == win && "Negamax must take the win");
+    }
+}
+
+} // namespace
+
+void TestDeadline() {
+    using game::Board;
+    using solution::Deadline;
+    std::cerr << "Test the deadline...\n";
+
+    const Deadline unlimited;
+    assert(unlimited.IsUnlimited() && !unlimited.IsExpired());
+    assert(Deadline { Deadline::Clock::now() }.IsExpired());
+    assert(!Deadline::After(60'000'000).IsExpired());
+    assert(Deadline::After(60'000'000).Capped(0).IsExpired());
+    solution::CancellationToken token;
+    const Deadline cancellable { &token };
+    assert(!cancellable.IsUnlimited() && !cancellable.IsExpired());
+    token.Cancel();
+    assert(cancellable.IsExpired() && cancellable.Capped(60'000'000).IsExpired());
+    token.Reset();
+    assert(!cancellable.IsExpired());
+
+    // 'x' moves first, the solvers play 'o'
+    Board boards[3];
+    boards[1].assign(1, 1, Board::Cell::X);
+    boards[2] = boards[1];
+    boards[2].assign(0, 0, Board::Cell::O);
+    boards[2].assign(2, 2, Board::Cell::X);
+    boards[0].assign(0, 0, Board::Cell::X);
+
+    using SolverPointer = std::unique_ptr<solution::Solver>;
+    SolverPointer solvers[] = {
+        SolverPointer { new solution::Minimax { 1 } }
+        , SolverPointer { new solution::AlphaBettaMinimax { 1 } }
+        , SolverPointer { new solution::AlphaBettaMinimax { 1, solution::AlphaBettaMinimax::UNLIMITED, 2 } }
+        , SolverPointer { new solution::Negamax { 1 } }
+        , SolverPointer { new solution::Negamax { 1, solution::Negamax::Mode::MTDF } }
+        , SolverPointer { new solution::MCTS { 1'000'000'000, 1'000'000'000, 100'000, 1 } }
+        , SolverPointer { new solution::PerfectPlay { 1 } }
+    };
+    for(auto& solver: solvers) {
+        for(const auto board: boards) {
+            // the expired deadline still gives a legal move
+            [[maybe_unused]] const auto expired = solver->Run(board, Deadline { Deadline::Clock::now() });
+            assert(expired < Board::SIZE && board.at(expired) == Board::Cell::FREE
+                && "The solver must return a free cell when the deadline has expired");
+            // the unlimited deadline doesn't change the move (this MCTS is only stopped by a deadline)
+            if(solver.get() != solvers[5].get()) {
+                assert(solver->Run(board, unlimited) == solver->Run(board)
+                    && "The unlimited deadline must not change the move");
+            }
+        }
+    }
+    // the search is stopped by another thread
+    std::thread canceller { [&token]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        token.Cancel();
+    } };
+    [[maybe_unused]] const auto move = solvers[5]->Run(boards[1], cancellable);
+    canceller.join();
+    assert(boards[1].at(move) == Board::Cell::FREE && "The cancelled search must return a free cell");
+
+    // x x x .
+    // o o o .
+    // x . . .
+    // . . . .  'o' wins by (1, 3) before 'x' does by (0, 3)
+    game::Board4x4 board4x4;
+    for(const auto cell: { 0, 1, 2, 8 }) {
+        board4x4.assign(static_cast<size_t>(cell), game::Cell::X);
+    }
+    for(const auto cell: { 4, 5, 6 }) {
+        board4x4.assign(static_cast<size_t>(cell), game::Cell::O);
+    }
+    TestWinInOne(board4x4, 7, true);
+    // the line of 3 'o' at the left edge of the row 3, the other end is blocked by 'x'
+    game::Board7x7 board7x7;
+    for(const auto cell: { 0, 6, 25, 48 }) {
+        board7x7.assign(static_cast<size_t>(cell), game::Cell::X);
+    }
+    for(const auto col: { 1, 2, 3 }) {
+        board7x7.assign(3, static_cast<size_t>(col), game::Cell::O);
+    }
+    TestWinInOne(board7x7, 21, false);
+    // the line of 4 'o' in the row 7 blocked by 'x' at the right end
+    game::Gomoku gomoku;
+    for(const auto cell: { 0, 1, 48, 7 * 15 + 9, 224 }) {
+        gomoku.assign(static_cast<size_t>(cell), game::Cell::X);
+    }
+    for(const auto col: { 5, 6, 7, 8 }) {
+        gomoku.assign(7, static_cast<size_t>(col), game::Cell::O);
+    }
+    TestWinInOne(gomoku, 7 * 15 + 4, false);
+    std::cerr << "Complete test.\n";
+}
@@ -0,0 +1,84 @@
+#ifndef DEADLINE_HPP_
+#define DEADLINE_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace solution {
+
+/**
+ * Cancellation flag shared by the caller and the solvers:
+ * the caller (usually from another thread) cancels the running search.
+ */
+class CancellationToken final {
+public:
+    void Cancel() noexcept {
+        m_cancelled.store(true, std::memory_order_relaxed);
+    }
+
+    // make the token usable for the next search
+    void Reset() noexcept {
+        m_cancelled.store(false, std::memory_order_relaxed);
+    }
+
+    bool IsCancelled() const noexcept {
+        return m_cancelled.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<bool> m_cancelled { false };
+};
+
+/**
+ * When `Solver::Run` must stop: at the time point or when the token is cancelled.
+ * The default deadline never expires. Solvers check it once per a number of nodes
+ * (iterations) and return the best move found so far.
+ * The token isn't owned and must outlive the search.
+ */
+class Deadline final {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    Deadline() noexcept = default;
+
+    explicit Deadline(Clock::time_point time, const CancellationToken* token = nullptr) noexcept
+        : m_time { time }
+        , m_token { token }
+    {}
+
+    explicit Deadline(const CancellationToken* token) noexcept
+        : m_token { token }
+    {}
+
+    // the deadline in `microseconds` from now
+    static Deadline After(uint64_t microseconds, const CancellationToken* token = nullptr) noexcept {
+        return Deadline { Clock::now() + std::chrono::microseconds(microseconds), token };
+    }
+
+    // the same deadline limited by `microseconds` from now
+    Deadline Capped(uint64_t microseconds) const noexcept {
+        return Deadline { std::min(m_time, Clock::now() + std::chrono::microseconds(microseconds)), m_token };
+    }
+
+    // reads the clock unless the deadline has no time point
+    bool IsExpired() const noexcept {
+        return (m_token && m_token->IsCancelled())
+            || (m_time != Clock::time_point::max() && Clock::now() >= m_time);
+    }
+
+    bool IsUnlimited() const noexcept {
+        return m_time == Clock::time_point::max() && !m_token;
+    }
+
+private:
+    Clock::time_point           m_time { Clock::time_point::max() };
+    const CancellationToken*    m_token { nullptr };
+};
+
+} // namespace solution
+
+void TestDeadline();
+
+#endif // DEADLINE_HPP_
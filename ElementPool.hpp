@@ -3,40 +3,176 @@
 
 #include <type_traits>
 #include <cassert>
-#include <vector>
+#include <cstddef>
+#include <atomic>
+#include <mutex>
+#include <new>
 
-template<class T, 
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+#endif
+
+/**
+ * Arena of elements: the address space for `capacity` elements is reserved
+ * at construction but memory is committed by chunks on demand,
+ * so neither construction time nor memory usage depend on the capacity.
+ * Elements never move (pointers are stable) and are constructed when acquired.
+ */
+template<class T,
     class = std::enable_if_t<std::is_default_constructible_v<T>>
 >
 class ElementPool final {
 public:
+    static_assert(std::is_trivially_destructible_v<T>,
+        "Elements are never destroyed, Reset just forgets them");
+
     static constexpr size_t CAPACITY { 1u << 20u };
+    // memory is committed by chunks of this size (it's also the huge page size)
+    static constexpr size_t CHUNK_SIZE { 1u << 21u };
+
+    /**
+     * @param capacity  max number of elements in the pool
+     * @param hugePages advise the OS to back the pool with huge pages (if supported)
+     */
+    explicit ElementPool(size_t capacity = CAPACITY, bool hugePages = false)
+        : m_capacity { capacity }
+        , m_reserved { (capacity * sizeof(T) + CHUNK_SIZE - 1u) / CHUNK_SIZE * CHUNK_SIZE }
+    {
+#ifdef _WIN32
+        (void) hugePages;
+        m_elements = static_cast<T*>(::VirtualAlloc(nullptr, m_reserved, MEM_RESERVE, PAGE_NOACCESS));
+        if(!m_elements) {
+            throw std::bad_alloc{};
+        }
+#else
+        auto memory = ::mmap(nullptr, m_reserved, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if(memory == MAP_FAILED) {
+            throw std::bad_alloc{};
+        }
+        m_elements = static_cast<T*>(memory);
+    #ifdef MADV_HUGEPAGE
+        if(hugePages) {
+            ::madvise(memory, m_reserved, MADV_HUGEPAGE);
+        }
+    #else
+        (void) hugePages;
+    #endif
+#endif
+    }
+
+    ElementPool(const ElementPool&) = delete;
+    ElementPool& operator=(const ElementPool&) = delete;
+
+    ~ElementPool() {
+#ifdef _WIN32
+        ::VirtualFree(m_elements, 0, MEM_RELEASE);
+#else
+        ::munmap(m_elements, m_reserved);
+#endif
+    }
 
     size_t Size() const noexcept {
-        return m_size;
+        return m_size.load(std::memory_order_relaxed);
     }
 
     size_t Capacity() const noexcept {
-        return CAPACITY;
+        return m_capacity;
     }
 
+    // number of bytes backed by memory
+    size_t Committed() const noexcept {
+        return m_committed.load(std::memory_order_relaxed);
+    }
+
+    // O(1): committed memory is kept for the next use
     void Reset() noexcept {
-        m_size = 0;
+        m_size.store(0, std::memory_order_relaxed);
     }
 
     bool IsFull() const noexcept {
-        return m_size >= CAPACITY;
+        return this->Size() >= m_capacity;
     }
 
-    T* Acquire() noexcept {
-        assert(m_size < CAPACITY && "Out of allocated nodes!");
-        m_size++;
-        return &m_elements[m_size - 1];
+    // @throw std::bad_alloc see `AcquireBlock`
+    T* Acquire() {
+        return this->AcquireBlock(1);
+    }
+
+    /**
+     * Thread-safe: can be used by several threads to get their own slices of the pool
+     * @return the first element of the contiguous block of `count` elements
+     * @throw std::bad_alloc when the block doesn't fit the capacity or the memory can't be committed
+     */
+    T* AcquireBlock(size_t count) {
+        auto first = m_size.load(std::memory_order_relaxed);
+        do {
+            if(count > m_capacity - first) {
+                throw std::bad_alloc{};
+            }
+        } while(!m_size.compare_exchange_weak(first, first + count, std::memory_order_relaxed));
+        const auto bytes = (first + count) * sizeof(T);
+        if(bytes > m_committed.load(std::memory_order_acquire)) {
+            this->Commit(bytes);
+        }
+        for(auto element = m_elements + first; element != m_elements + first + count; element++) {
+            new (element) T{};
+        }
+        return m_elements + first;
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < this->Size() && "Out of the pool!");
+        return m_elements[index];
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        assert(index < this->Size() && "Out of the pool!");
+        return m_elements[index];
+    }
+
+    // @return index of the element acquired from this pool
+    size_t IndexOf(const T* element) const noexcept {
+        assert(element >= m_elements && element < m_elements + m_capacity && "Not in the pool!");
+        return static_cast<size_t>(element - m_elements);
     }
 
 private:
-    std::vector<T> m_elements { CAPACITY };
-    size_t m_size { 0u };
+    /**
+     * Commit chunks to back at least `bytes` bytes
+     * @throw std::bad_alloc when the OS refuses, nothing is committed then
+     */
+    void Commit(size_t bytes) {
+        std::lock_guard<std::mutex> lock { m_commitMutex };
+        auto committed = m_committed.load(std::memory_order_relaxed);
+        if(bytes <= committed) {
+            return;
+        }
+        const auto required = (bytes + CHUNK_SIZE - 1u) / CHUNK_SIZE * CHUNK_SIZE;
+        auto begin = reinterpret_cast<char*>(m_elements) + committed;
+#ifdef _WIN32
+        if(!::VirtualAlloc(begin, required - committed, MEM_COMMIT, PAGE_READWRITE)) {
+            throw std::bad_alloc{};
+        }
+#else
+        if(::mprotect(begin, required - committed, PROT_READ | PROT_WRITE) != 0) {
+            throw std::bad_alloc{};
+        }
+#endif
+        m_committed.store(required, std::memory_order_release);
+    }
+
+    T*                  m_elements { nullptr };
+    const size_t        m_capacity { CAPACITY };
+    // size of the reserved address space in bytes
+    const size_t        m_reserved { 0u };
+    std::atomic<size_t> m_size { 0u };
+    std::atomic<size_t> m_committed { 0u };
+    std::mutex          m_commitMutex;
 };
 
-#endif // ELEMENT_POOL_HPP_
\ No newline at end of file
+#endif // ELEMENT_POOL_HPP_
@@ -0,0 +1,69 @@
+#ifndef GAME_HPP_
+#define GAME_HPP_
+
+#include "Board.hpp"
+
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+
+namespace solution {
+
+/**
+ * Player mapping known at compile time: the player 0 plays `First`,
+ * the player 1 - the other mark
+ */
+template<game::Cell First>
+struct Players {
+    static_assert(First != game::Cell::FREE, "The player must be mapped to 'x' or 'o'");
+
+    // @param player identity (basicaly correspond to his turn in the game)
+    static constexpr game::Cell Mark(uint8_t player) noexcept {
+        return (player == 0) == (First == game::Cell::X)? game::Cell::X : game::Cell::O;
+    }
+};
+
+using XFirst = Players<game::Cell::X>;
+
+/**
+ * Rules of the game the engines are built for. The engines are templates over it
+ * and call it statically, so the rules are inlined into their loops.
+ * A game type provides:
+ * - `State_t` - the position (see `game::BasicBoard`);
+ * - `GetState(state)`, `GetState(state, lastMove)` - see `game::GetGameState`;
+ * - `IsTerminal(state)`;
+ * - `GetNextPlayer(player)`;
+ * - `Mark(player)` - the player mapping.
+ */
+template<class Board_t, class Players_t = XFirst>
+struct BasicGame {
+    using State_t = Board_t;
+
+    static constexpr std::pair<game::State, game::Cell> GetState(State_t state) noexcept {
+        return game::GetGameState(state);
+    }
+
+    // @param lastMove the cell of the move made the state: only its lines are checked
+    static constexpr std::pair<game::State, game::Cell> GetState(State_t state, size_t lastMove) noexcept {
+        return game::GetGameState(state, lastMove);
+    }
+
+    // can't continue
+    static constexpr bool IsTerminal(State_t state) noexcept {
+        return game::GetGameState(state).first != game::State::ONGOING;
+    }
+
+    static constexpr uint8_t GetNextPlayer(uint8_t player) noexcept {
+        return ++player & 1;
+    }
+
+    static constexpr game::Cell Mark(uint8_t player) noexcept {
+        return Players_t::Mark(player);
+    }
+};
+
+using TicTacToe = BasicGame<game::Board>;
+
+} // namespace solution
+
+#endif // GAME_HPP_
@@ -0,0 +1,317 @@
+#include "Board.hpp"
+#include "Random.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#ifndef _WIN32
+    #include <sys/socket.h>
+    #include <sys/un.h>
+    #include <unistd.h>
+#endif
+
+/**
+ * Load generator for the headless server (`tic-tac-toe --headless --socket <path>`).
+ * Each connection plays games against the engine making random moves and keeps
+ * `pipeline` games in flight; the latency of `go` is measured from sending the request
+ * to receiving the response.
+ * Usage: tic-tac-toe-load <socket> [--connections N] [--games N] [--pipeline N] [--solver S] [--budget US]
+ */
+
+namespace {
+
+using game::Board;
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    std::string m_socket;
+    size_t      m_connections { 4 };
+    // per connection
+    size_t      m_games { 100 };
+    size_t      m_pipeline { 8 };
+    std::string m_solver { "alphabeta" };
+    // 0 - the solver's own limits
+    uint64_t    m_budget { 0 };
+};
+
+struct Results {
+    // latencies of `go` in microseconds
+    std::vector<double> m_latencies;
+    size_t  m_games { 0 };
+    size_t  m_errors { 0 };
+    // results of the engine
+    size_t  m_wins { 0 };
+    size_t  m_draws { 0 };
+    size_t  m_losses { 0 };
+
+    void Merge(const Results& other) {
+        m_latencies.insert(m_latencies.end(), other.m_latencies.begin(), other.m_latencies.end());
+        m_games += other.m_games;
+        m_errors += other.m_errors;
+        m_wins += other.m_wins;
+        m_draws += other.m_draws;
+        m_losses += other.m_losses;
+    }
+};
+
+#ifndef _WIN32
+
+// plays the games of one connection, the engine plays 'o'
+class Connection final {
+public:
+    Connection(const Options& options, int socket, uint32_t seed)
+        : m_options { options }
+        , m_socket { socket }
+        , m_random { seed }
+    {}
+
+    Results Run() {
+        for(size_t i = 0; i < std::min(m_options.m_pipeline, m_options.m_games); i++) {
+            this->Start();
+        }
+        char buffer[4096];
+        std::string input;
+        while(m_expected > 0) {
+            if(!this->Flush()) {
+                // the responses of the requests sent before won't be read either
+                std::cerr << "Failed to send the requests\n";
+                m_results.m_errors += m_expected;
+                break;
+            }
+            const auto received = ::read(m_socket, buffer, sizeof(buffer));
+            if(received <= 0) {
+                std::cerr << "The server closed the connection\n";
+                m_results.m_errors += m_expected;
+                break;
+            }
+            input.append(buffer, static_cast<size_t>(received));
+            size_t first { 0 };
+            for(auto last = input.find('\n'); last != std::string::npos; last = input.find('\n', first)) {
+                this->Receive(input.substr(first, last - first));
+                first = last + 1;
+            }
+            input.erase(0, first);
+        }
+        return m_results;
+    }
+
+private:
+    struct Game {
+        Board               m_board {};
+        Clock::time_point   m_sent {};
+    };
+
+    void Send(const std::string& line) {
+        m_output += line;
+        m_output += '\n';
+        m_expected++;
+    }
+
+    // @return false when the server doesn't accept the requests
+    bool Flush() {
+        for(size_t sent = 0; sent < m_output.size();) {
+            const auto written = ::send(m_socket, m_output.data() + sent, m_output.size() - sent, 0);
+            if(written <= 0) {
+                return false;
+            }
+            sent += static_cast<size_t>(written);
+        }
+        m_output.clear();
+        return true;
+    }
+
+    void Start() {
+        const auto id = std::to_string(m_started++);
+        m_games[id] = Game{};
+        this->Send("n" + id + " new g" + id + ' ' + m_options.m_solver + " o");
+        this->Play(id);
+    }
+
+    // the random move of 'x' followed by the engine's move
+    void Play(const std::string& id) {
+        auto& game = m_games[id];
+        const auto cell = solution::RandomCell(game::Cells { game.m_board.freeCells() }, m_random);
+        game.m_board.assign(cell, Board::Cell::X);
+        this->Send("m" + id + " move g" + id + ' ' + std::to_string(cell));
+        if(game::GetGameState(game.m_board).first != Board::State::ONGOING) {
+            this->Finish(id);
+            return;
+        }
+        game.m_sent = Clock::now();
+        this->Send("q" + id + " go g" + id + (m_options.m_budget? ' ' + std::to_string(m_options.m_budget) : ""));
+    }
+
+    void Finish(const std::string& id) {
+        const auto [state, winner] = game::GetGameState(m_games[id].m_board);
+        m_results.m_games++;
+        m_results.m_draws += state == Board::State::DRAW;
+        m_results.m_wins += state == Board::State::WIN && winner == Board::Cell::O;
+        m_results.m_losses += state == Board::State::WIN && winner == Board::Cell::X;
+        m_games.erase(id);
+        this->Send("e" + id + " end g" + id);
+        if(m_started < m_options.m_games) {
+            this->Start();
+        }
+    }
+
+    void Receive(const std::string& line) {
+        m_expected--;
+        const auto space = line.find(' ');
+        if(space == std::string::npos || line.compare(space + 1, 2, "ok") != 0) {
+            if(m_results.m_errors++ < 10) {
+                std::cerr << "Unexpected response: " << line << "\n";
+            }
+            return;
+        }
+        if(line[0] != 'q') {
+            return;
+        }
+        const auto id = line.substr(1, space - 1);
+        auto& game = m_games[id];
+        m_results.m_latencies.push_back(static_cast<double>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - game.m_sent).count()) * 1e-3);
+        // `<tag> ok <cell> <state> ...`
+        const auto cell = static_cast<size_t>(std::stoul(line.substr(space + 4)));
+        game.m_board.assign(cell, Board::Cell::O);
+        if(game::GetGameState(game.m_board).first != Board::State::ONGOING) {
+            this->Finish(id);
+        }
+        else {
+            this->Play(id);
+        }
+    }
+
+    const Options&  m_options;
+    const int       m_socket;
+    solution::Xorshift32 m_random;
+    // games in flight by id
+    std::unordered_map<std::string, Game> m_games{};
+    size_t          m_started { 0 };
+    // responses not received yet
+    size_t          m_expected { 0 };
+    std::string     m_output{};
+    Results         m_results{};
+};
+
+int Connect(const std::string& path) {
+    sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+    if(path.size() >= sizeof(address.sun_path)) {
+        return -1;
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    const auto connection = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if(connection >= 0 && ::connect(connection, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        ::close(connection);
+        return -1;
+    }
+    return connection;
+}
+
+#endif
+
+double Percentile(const std::vector<double>& sorted, double p) {
+    if(sorted.empty()) {
+        return 0.;
+    }
+    return sorted[static_cast<size_t>(p * static_cast<double>(sorted.size() - 1) + 0.5)];
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    const auto usage = [argv]() {
+        std::cerr << "Usage: " << argv[0] << " <socket> [--connections N] [--games N] [--pipeline N]"
+            << " [--solver minimax|alphabeta|negamax|mcts|perfect] [--budget US]\n";
+        return 1;
+    };
+    if(argc < 2) {
+        return usage();
+    }
+    options.m_socket = argv[1];
+    for(int i = 2; i < argc; i++) {
+        const std::string arg { argv[i] };
+        if(i + 1 >= argc) {
+            return usage();
+        }
+        const std::string value { argv[++i] };
+        if(arg == "--connections") {
+            options.m_connections = std::max<size_t>(1, std::stoul(value));
+        }
+        else if(arg == "--games") {
+            options.m_games = std::max<size_t>(1, std::stoul(value));
+        }
+        else if(arg == "--pipeline") {
+            options.m_pipeline = std::max<size_t>(1, std::stoul(value));
+        }
+        else if(arg == "--solver") {
+            options.m_solver = value;
+        }
+        else if(arg == "--budget") {
+            options.m_budget = std::stoull(value);
+        }
+        else {
+            return usage();
+        }
+    }
+
+#ifdef _WIN32
+    std::cerr << "Unix sockets aren't supported on this platform\n";
+    return 1;
+#else
+    // the failed `send` is reported by its result
+    std::signal(SIGPIPE, SIG_IGN);
+    std::vector<int> sockets;
+    for(size_t i = 0; i < options.m_connections; i++) {
+        sockets.push_back(Connect(options.m_socket));
+        if(sockets.back() < 0) {
+            std::cerr << "Can't connect to " << options.m_socket << ": " << std::strerror(errno) << "\n";
+            return 1;
+        }
+    }
+    Results total;
+    std::mutex mutex;
+    std::vector<std::thread> threads;
+    const auto start = Clock::now();
+    for(size_t i = 0; i < sockets.size(); i++) {
+        threads.emplace_back([&options, &total, &mutex, socket = sockets[i], i]() {
+            Connection connection { options, socket, static_cast<uint32_t>(i + 1) * 0x9E3779B9u };
+            const auto results = connection.Run();
+            std::lock_guard<std::mutex> lock { mutex };
+            total.Merge(results);
+        });
+    }
+    for(auto& thread: threads) {
+        thread.join();
+    }
+    const auto seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    for(const auto socket: sockets) {
+        ::close(socket);
+    }
+
+    auto& latencies = total.m_latencies;
+    std::sort(latencies.begin(), latencies.end());
+    double sum { 0. };
+    for(const auto latency: latencies) {
+        sum += latency;
+    }
+    std::cout << "connections: " << options.m_connections << ", pipeline: " << options.m_pipeline
+        << ", solver: " << options.m_solver << "\n";
+    std::cout << "games: " << total.m_games << ", moves: " << latencies.size() << ", errors: " << total.m_errors
+        << ", elapsed: " << seconds * 1e3 << " ms, moves/s: " << static_cast<double>(latencies.size()) / seconds << "\n";
+    std::cout << "latency (us): mean: " << (latencies.empty()? 0. : sum / static_cast<double>(latencies.size()))
+        << ", p50: " << Percentile(latencies, 0.5) << ", p90: " << Percentile(latencies, 0.9)
+        << ", p99: " << Percentile(latencies, 0.99) << ", max: " << (latencies.empty()? 0. : latencies.back()) << "\n";
+    std::cout << "engine: wins: " << total.m_wins << ", draws: " << total.m_draws << ", losses: " << total.m_losses << "\n";
+    return total.m_errors? 1 : 0;
+#endif
+}
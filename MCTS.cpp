@@ -1,214 +1,686 @@
 #include "MCTS.hpp"
+#include "PerfectPlay.hpp"
 
 #include <cassert>
 #include <chrono>
 #include <algorithm>
-
+#include <thread>
+#include <limits>
+#include <cmath>
 #include <iostream>
 
 namespace solution {
 
-MCTS::MCTS(uint64_t timeLimit
+template<class Game_t>
+BasicMCTS<Game_t>::BasicMCTS(uint64_t timeLimit
     , uint64_t iterations
     , uint64_t treeSize
     , uint8_t player
-    , Mapping_t && playerMapping
+    , size_t threads
+    , size_t playouts
+    , uint32_t raveEquivalence
+    , bool symmetric
 )
-    : Solver { player, std::move(playerMapping) }
+    : Solver_t { player }
     , m_timeLimit { timeLimit }
     , m_iterations { iterations }
     , m_treeSize { treeSize }
-    , m_engine{}
+    , m_playouts { playouts }
+    , m_raveEquivalence { raveEquivalence }
+    , m_symmetric { symmetric }
+    , m_pool { PoolCapacity(treeSize, threads) }
+    , m_visits { PoolCapacity(treeSize, threads) }
+    , m_rewards { PoolCapacity(treeSize, threads) }
+    , m_amafVisits { PoolCapacity(treeSize, threads) }
+    , m_amafRewards { PoolCapacity(treeSize, threads) }
+    , m_workers(threads)
 {
-    assert(m_treeSize + State_t::SIZE < m_pool.Capacity() 
-        && "Can't be greater or equal to memory pool capacity because expansion may fail to get Node");
+    assert(m_treeSize > 0 && "The tree must have room for the root");
     assert(m_player <= 1 
         && "Player ID must belong to range [0, 1");
+    assert(!m_workers.empty() && "At least one worker is required");
+    assert(m_playouts > 0 && "At least one playout is required");
+    for(size_t i = 0; i < m_workers.size(); i++) {
+        m_workers[i].m_random = Xorshift32 { static_cast<uint32_t>(i + 1) * 0x9E3779B9u };
+        m_workers[i].m_playout = Playout_t { static_cast<uint32_t>(i + 1) };
+    }
+}
+
+namespace {
+
+    // std::atomic<float> doesn't have `fetch_add` in C++17
+    void AtomicAdd(std::atomic<float>& target, float value) noexcept {
+        auto current = target.load(std::memory_order_relaxed);
+        while(!target.compare_exchange_weak(current, current + value, std::memory_order_relaxed)) {}
+    }
+
+} // namespace
+
+template<class Game_t>
+typename BasicMCTS<Game_t>::Index_t BasicMCTS<Game_t>::AcquireNodes(size_t count) {
+    std::lock_guard<std::mutex> lock { m_poolMutex };
+    const auto first = m_pool.AcquireBlock(count);
+    m_visits.AcquireBlock(count);
+    m_rewards.AcquireBlock(count);
+    if(m_raveEquivalence) {
+        m_amafVisits.AcquireBlock(count);
+        m_amafRewards.AcquireBlock(count);
+    }
+    assert(m_visits.Size() == m_pool.Size() && m_rewards.Size() == m_pool.Size() 
+        && "Statistics must be allocated along with nodes");
+    return static_cast<Index_t>(m_pool.IndexOf(first));
+}
+
+template<class Game_t>
+void BasicMCTS<Game_t>::ResetPools() noexcept {
+    m_pool.Reset();
+    m_visits.Reset();
+    m_rewards.Reset();
+    m_amafVisits.Reset();
+    m_amafRewards.Reset();
+}
+
+template<class Game_t>
+void BasicMCTS<Game_t>::InitNode(Index_t index, State_t state, uint8_t player, game::State result) noexcept {
+    auto& node = m_pool[index];
+    node.m_state = state;
+    node.m_children = 0u;
+    node.m_count = 0u;
+    node.m_player = player;
+    node.m_status.store(Node::LEAF, std::memory_order_relaxed);
+    // the win can be only made by the last move
+    node.m_proof.store(result == game::State::WIN? Node::WIN
+        : result == game::State::DRAW? Node::DRAW
+        : Node::UNKNOWN, std::memory_order_relaxed);
+    m_visits[index].store(0u, std::memory_order_relaxed);
+    m_rewards[index].store(0.f, std::memory_order_relaxed);
+    if(m_raveEquivalence) {
+        m_amafVisits[index].store(0u, std::memory_order_relaxed);
+        m_amafRewards[index].store(0.f, std::memory_order_relaxed);
+    }
 }
 
-float MCTS::UCT(const Node* node, const Node* parent) const noexcept {
+template<class Game_t>
+float BasicMCTS<Game_t>::UCT(Index_t node, float logParentVisits) const noexcept {
     const auto C = 2.f;
-    const auto exploit = node->m_reward / node->m_visits;
-    const auto explore = sqrtf(logf(static_cast<float>(parent->m_visits)) / static_cast<float>(node->m_visits));
+    const auto visits = static_cast<float>(m_visits[node].load(std::memory_order_relaxed));
+    auto exploit = visits > 0.f? m_rewards[node].load(std::memory_order_relaxed) / visits : 0.f;
+    if(m_raveEquivalence) {
+        if(const auto amafVisits = m_amafVisits[node].load(std::memory_order_relaxed); amafVisits) {
+            // the weight of the AMAF value decreases with own visits: 1/2 after `m_raveEquivalence` visits
+            const auto k = static_cast<float>(m_raveEquivalence);
+            const auto beta = sqrtf(k / (3.f * visits + k));
+            const auto amaf = m_amafRewards[node].load(std::memory_order_relaxed) / static_cast<float>(amafVisits);
+            exploit = (1.f - beta) * exploit + beta * amaf;
+        }
+    }
+    // the unvisited node (possible only with RAVE) is explored as visited once
+    const auto explore = sqrtf(logParentVisits / std::max(visits, 1.f));
     return exploit + C * explore;
 }
 
+template<class Game_t>
+float BasicMCTS<Game_t>::VirtualLoss(Index_t node) const noexcept {
+    // the rewards of the opponent's nodes are negated, see `BackupNegamax`
+    return m_pool[node].m_player == m_player? 0.f : -1.f;
+}
+
+template<class Game_t>
+void BasicMCTS<Game_t>::ApplyVirtualLoss(Index_t node) noexcept {
+    m_visits[node].fetch_add(1u, std::memory_order_relaxed);
+    AtomicAdd(m_rewards[node], this->VirtualLoss(node));
+}
+
 // recursively selected node using utility function
 // return selected base on utility function node (it can be 
-// either terminal either non-expanded) 
-Node* MCTS::Select(Node* node) const noexcept {
-    while(!IsLeaf(node) && !IsTerminal(node->m_state)) {
+// either terminal either non-expanded). 
+// Each selected node gets virtual loss which is reverted by the backup.
+template<class Game_t>
+typename BasicMCTS<Game_t>::Index_t BasicMCTS<Game_t>::Select(Worker& worker) noexcept {
+    // the root is always the first node
+    Index_t node { 0u };
+    worker.m_depth = 0;
+    worker.m_path[worker.m_depth++] = node;
+    // the subtree of the proven node isn't searched: its value is known,
+    // the terminal nodes are proven by `InitNode`
+    while(!IsLeaf(node) && m_pool[node].m_proof.load(std::memory_order_relaxed) == Node::UNKNOWN) {
         // avoid std::max_element because it performs too many useless calls to UCT
-        Node *bestNode { nullptr };
-        auto bestUCT = 0.f; 
-        for(auto child: node->m_children) {
-            if(!child->m_visits) {
-                bestNode = child;
-                break;
+        const auto first = m_pool[node].m_children;
+        const auto last = first + m_pool[node].m_count;
+        const auto logVisits = logf(static_cast<float>(m_visits[node].load(std::memory_order_relaxed)));
+        Index_t bestNode { first };
+        auto bestUCT = std::numeric_limits<float>::lowest(); 
+        for(auto child = first; child < last; child++) {
+            // the player never makes the move proven to lose
+            if(m_pool[child].m_proof.load(std::memory_order_relaxed) == Node::LOSS) {
+                continue;
             }
-            const auto uct = this->UCT(child, node);
-            if(bestNode == nullptr) {
+            // with RAVE the unvisited node is compared by its AMAF value if it has one
+            if(!m_visits[child].load(std::memory_order_relaxed)
+                && (!m_raveEquivalence || !m_amafVisits[child].load(std::memory_order_relaxed))
+            ) {
                 bestNode = child;
-                bestUCT = uct;
+                break;
             }
-            else if(uct > bestUCT) {
+            const auto uct = this->UCT(child, logVisits);
+            if(uct > bestUCT) {
                 bestNode = child;
                 bestUCT = uct;
             }
         }
         node = bestNode;
+        worker.m_path[worker.m_depth++] = node;
+        this->ApplyVirtualLoss(node);
     }
     return node;
 }
 
-// expand selected node adding all possible children
-void MCTS::Expand(Node* node) {
-    for(size_t i = 0; i < State_t::SIZE; i++) {
-        auto row = i / 3;
-        auto col = i % 3;
-        // is empty so we can take action
-        if(node->m_state.at(row, col) == State_t::Cell::FREE) {
-            auto child = m_pool.Acquire();
-            *child = Node{};
-            child->m_parent = node;
-            child->m_player = this->GetNextPlayer(node->m_player);
-            child->m_state = node->m_state;
-            child->m_state.assign(row, col, m_playerMapping(child->m_player));
-            node->m_children.emplace_back(child);
-        }
+// expand selected node adding all possible children as one block, 
+// the caller must own the node (see `Node::EXPANDING`)
+template<class Game_t>
+void BasicMCTS<Game_t>::Expand(Index_t index, Worker& worker) {
+    auto& node = m_pool[index];
+    const game::Cells moves { m_symmetric? game::UniqueMoves(node.m_state) : node.m_state.freeCells() };
+    const auto freeCells = moves.size();
+    if(worker.m_sliceSize < freeCells) {
+        worker.m_slice = this->AcquireNodes(SLICE_SIZE);
+        worker.m_sliceSize = SLICE_SIZE;
+    }
+    const auto first = worker.m_slice;
+    worker.m_slice += static_cast<Index_t>(freeCells);
+    worker.m_sliceSize -= freeCells;
+    worker.m_allocated += freeCells;
+
+    const auto player = Game_t::GetNextPlayer(node.m_player);
+    const auto mark = Game_t::Mark(player);
+    auto child = first;
+    for(const auto i: moves) {
+        const auto state = node.m_state.assigned(i, mark);
+        this->InitNode(child++, state, player, Game_t::GetState(state, i).first);
     }
+    node.m_children = first;
+    node.m_count = static_cast<uint8_t>(freeCells);
+    node.m_status.store(Node::EXPANDED, std::memory_order_release);
 }
 
-// Is run from expanded node and return reward
-float MCTS::Simulate(Node* expanded) {
-    using game::Board;
+// Is run from expanded node and return reward averaged over `m_playouts` games
+// or the exact reward when the node is proven
+template<class Game_t>
+float BasicMCTS<Game_t>::Simulate(Index_t expanded, Worker& worker) const {
+    const auto& node = m_pool[expanded];
+    worker.m_hasAmaf = false;
+    // the proven value is exact, no need to play
+    if(const auto proof = node.m_proof.load(std::memory_order_relaxed); proof != Node::UNKNOWN) {
+        const auto isMine = node.m_player == m_player;
+        return proof == Node::DRAW? DRAW_REWARD
+            : (proof == Node::WIN) == isMine? 1.f : 0.f;
+    }
     // use out-of-tree policy for play-out
-    auto state = expanded->m_state;
-    auto player = expanded->m_player;
-    auto gameState = game::GetGameState(state);
-    while(gameState.first == Board::State::ONGOING) {
-        // perform random action
-        std::vector<size_t> actions;
-        actions.reserve(Board::SIZE - 1);
-        for(size_t i = 0; i < Board::SIZE; i++) {
-            const auto row = i / 3;
-            const auto col = i % 3;
-            // is empty so we can take action
-            if(state.at(row, col) == Board::Cell::FREE) {
-                actions.push_back(i);
+    const auto mover = Game_t::Mark(Game_t::GetNextPlayer(node.m_player));
+    const auto result = worker.m_playout.Run(node.m_state, mover, m_playouts
+        , m_raveEquivalence? &worker.m_amaf : nullptr);
+    worker.m_hasAmaf = m_raveEquivalence != 0;
+    const auto me = static_cast<size_t>(Game_t::Mark(m_player));
+    return (static_cast<float>(result.m_wins[me]) + DRAW_REWARD * static_cast<float>(result.m_draws)) 
+        / static_cast<float>(m_playouts);
+}
+
+template<class Game_t>
+void BasicMCTS<Game_t>::Backup(const Worker& worker, float reward) {
+    assert(worker.m_depth > 0 && "[ERROR] can't backup empty path!");
+    for(size_t i = 0; i < worker.m_depth; i++) {
+        const auto node = worker.m_path[i];
+        AtomicAdd(m_rewards[node], reward);
+        m_visits[node].fetch_add(1u, std::memory_order_relaxed);
+    }
+}
+
+// all nodes except the root already have the visit and virtual loss applied by the selection
+template<class Game_t>
+void BasicMCTS<Game_t>::BackupNegamax(const Worker& worker, float reward) {
+    assert(worker.m_depth > 0 && "[ERROR] can't backup empty path!");
+    for(size_t i = 0; i < worker.m_depth; i++) {
+        const auto node = worker.m_path[i];
+        const auto value = m_pool[node].m_player == m_player? reward : -reward;
+        if(i > 0) {
+            AtomicAdd(m_rewards[node], value - this->VirtualLoss(node));
+        }
+        else {
+            AtomicAdd(m_rewards[node], value);
+            m_visits[node].fetch_add(1u, std::memory_order_relaxed);
+        }
+    }
+}
+
+template<class Game_t>
+void BasicMCTS<Game_t>::BackupAmaf(const Worker& worker) {
+    if(!worker.m_hasAmaf) {
+        return;
+    }
+    const auto& amaf = worker.m_amaf;
+    const auto me = static_cast<size_t>(Game_t::Mark(m_player));
+    // the last node of the path is a leaf
+    for(size_t i = 0; i + 1 < worker.m_depth; i++) {
+        const auto& node = m_pool[worker.m_path[i]];
+        const auto freeCells = node.m_state.freeCells();
+        for(auto child = node.m_children; child < node.m_children + node.m_count; child++) {
+            const auto player = m_pool[child].m_player;
+            const auto mark = static_cast<size_t>(Game_t::Mark(player));
+            const auto cell = game::details::LowestBit(freeCells & ~m_pool[child].m_state.freeCells());
+            const auto games = amaf.m_games[mark][cell];
+            if(!games) {
+                continue;
             }
+            // the reward of the AI is negated for the opponent's nodes as by `BackupNegamax`
+            const auto draws = games - amaf.m_wins[mark][cell] - amaf.m_losses[mark][cell];
+            const auto wins = mark == me? amaf.m_wins[mark][cell] : amaf.m_losses[mark][cell];
+            const auto reward = static_cast<float>(wins) + DRAW_REWARD * static_cast<float>(draws);
+            m_amafVisits[child].fetch_add(games, std::memory_order_relaxed);
+            AtomicAdd(m_amafRewards[child], player == m_player? reward : -reward);
         }
-        // choose action
-        const size_t randomAction = m_engine() % actions.size();
-        player = this->GetNextPlayer(player);
-        state.assign(actions[randomAction] / 3, actions[randomAction] % 3, m_playerMapping(player));
-        gameState = game::GetGameState(state);
     }
-    float reward = 0.f;
-    switch(gameState.first) {
-        case Board::State::WIN: {
-            const auto winner = static_cast<decltype(m_player)>(gameState.second);
-            reward = (m_player == winner? 1.f: 0.f); 
-        } break;
-        case Board::State::DRAW: {
-            reward = 0.3f; 
-        } break;
-        case Board::State::ONGOING: {
-            assert(false && "[ERROR] unreachable state!"); 
-        } break;
-        default: break;
+}
+
+template<class Game_t>
+Node::Proof BasicMCTS<Game_t>::ProveByChildren(Index_t index) const noexcept {
+    const auto& node = m_pool[index];
+    bool hasDraw { false };
+    for(auto child = node.m_children; child < node.m_children + node.m_count; child++) {
+        switch(m_pool[child].m_proof.load(std::memory_order_relaxed)) {
+            // the opponent has a winning move
+            case Node::WIN: return Node::LOSS;
+            case Node::UNKNOWN: return Node::UNKNOWN;
+            case Node::DRAW: hasDraw = true; break;
+            default: break;
+        }
     }
-    return reward;
+    // all opponent's moves are proven: they lose or draw at best
+    return hasDraw? Node::DRAW : Node::WIN;
 }
 
-void MCTS::Backup(Node* node, float reward) {
-    assert(node && "[ERROR] can't backup nullptr!");
-    node->m_reward += reward;
-    node->m_visits++;
+template<class Game_t>
+void BasicMCTS<Game_t>::Prove(const Worker& worker) noexcept {
+    for(auto i = worker.m_depth - 1; i > 0; i--) {
+        if(m_pool[worker.m_path[i]].m_proof.load(std::memory_order_relaxed) == Node::UNKNOWN) {
+            break;
+        }
+        const auto parent = worker.m_path[i - 1];
+        const auto proof = this->ProveByChildren(parent);
+        if(proof == Node::UNKNOWN) {
+            break;
+        }
+        m_pool[parent].m_proof.store(proof, std::memory_order_relaxed);
+    }
+}
+
+namespace {
+
+/**
+ * Counts the phases of an iteration and times them when the iteration is sampled.
+ * Does nothing unless built with `MCTS_INSTRUMENTATION`.
+ */
+template<class MCTS_t>
+class PhaseProbe final {
+public:
+#ifdef MCTS_INSTRUMENTATION
+    PhaseProbe(typename MCTS_t::Stats& stats, bool sampled) noexcept
+        : m_stats { stats }
+        , m_sampled { sampled }
+        , m_last { sampled? CycleClock::Now() : 0u }
+    {
+        m_stats.m_samples += sampled;
+    }
+
+    // the phase has just finished
+    void Mark(typename MCTS_t::Phase phase) noexcept {
+        m_stats.m_calls[phase]++;
+        if(m_sampled) {
+            const auto now = CycleClock::Now();
+            m_stats.m_ticks[phase] += now - m_last;
+            m_last = now;
+        }
+    }
+
+    void Depth(size_t depth) noexcept {
+        m_stats.m_depthSum += depth;
+        m_stats.m_maxDepth = std::max(m_stats.m_maxDepth, depth);
+    }
+
+    void Children(size_t count) noexcept {
+        m_stats.m_children += count;
+    }
+
+private:
+    typename MCTS_t::Stats&    m_stats;
+    const bool      m_sampled;
+    uint64_t        m_last;
+#else
+    PhaseProbe(typename MCTS_t::Stats&, bool) noexcept {}
+    void Mark(typename MCTS_t::Phase) noexcept {}
+    void Depth(size_t) noexcept {}
+    void Children(size_t) noexcept {}
+#endif
+};
+
+} // namespace
+
+template<class Game_t>
+void BasicMCTS<Game_t>::Search(Worker& worker, std::atomic<int64_t>& simulationLimit) {
+    worker.m_iterations = 0;
+    worker.m_allocated = 0;
+    worker.m_elapsed = 0;
+    worker.m_sliceSize = 0;
+    worker.m_stats = Stats{};
+    const auto start = std::chrono::steady_clock::now();
+    // at least one iteration is made: the root must be expanded to have a move
+    bool expired { false };
+    while(simulationLimit.fetch_sub(1, std::memory_order_relaxed) > 0
+        && !expired
+        && m_pool.Size() < m_treeSize
+        // each worker may take one more slice (the reused subtree may be larger than the limit)
+        && m_pool.Size() + m_workers.size() * SLICE_SIZE <= m_pool.Capacity()
+        // nothing to search when the root is proven
+        && m_pool[0].m_proof.load(std::memory_order_relaxed) == Node::UNKNOWN
+    ) {
+        PhaseProbe<BasicMCTS> probe { worker.m_stats, worker.m_iterations % SAMPLE_PERIOD == 0 };
+        worker.m_iterations++;
+        auto selected = this->Select(worker);
+        probe.Mark(SELECT);
+        auto& node = m_pool[selected];
+        uint8_t status = Node::LEAF;
+        // only one worker can expand the node, the others simulate from it;
+        // the proven leaf is terminal (see `Select`), its value is known
+        if(node.m_proof.load(std::memory_order_relaxed) == Node::UNKNOWN
+            && node.m_status.compare_exchange_strong(status, Node::EXPANDING, std::memory_order_relaxed)
+        ) {
+            this->Expand(selected, worker);
+            assert(node.m_count > 0 && "[ERROR] problems with expand function!");
+            // select random value base on random tree-policy
+            selected = node.m_children + static_cast<Index_t>(worker.m_random(node.m_count));
+            worker.m_path[worker.m_depth++] = selected;
+            this->ApplyVirtualLoss(selected);
+            probe.Children(node.m_count);
+            probe.Mark(EXPAND);
+        }
+        probe.Depth(worker.m_depth - 1);
+
+        const auto reward = this->Simulate(selected, worker);
+        probe.Mark(SIMULATE);
+        this->BackupNegamax(worker, reward);
+        this->BackupAmaf(worker);
+        this->Prove(worker);
+        probe.Mark(BACKUP);
+        // the clock is read once per a few iterations
+        if(worker.m_iterations % CHECK_PERIOD == 0) {
+            expired = m_deadline.IsExpired();
+        }
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    worker.m_elapsed = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+}
 
-    if(node->m_parent) {
-        this->Backup(node->m_parent, reward);
+template<class Game_t>
+std::pair<typename BasicMCTS<Game_t>::Index_t, size_t> BasicMCTS<Game_t>::FindNode(State_t board) const noexcept {
+    if(!m_pool.Size()) {
+        return { NOT_FOUND, 0 };
+    }
+    // the move symmetric to the one made on the board may represent it
+    State_t images[State_t::SYMMETRIES] {};
+    const size_t symmetries { m_symmetric? State_t::SYMMETRIES : 1U };
+    for(size_t s = 0; s < symmetries; s++) {
+        images[s] = s? game::Transform(board, s) : board;
+    }
+    // @return the symmetry which maps the state to the board or `SYMMETRIES`
+    const auto match = [&images, symmetries](const State_t& state) {
+        for(size_t s = 0; s < symmetries; s++) {
+            if(state == images[s]) {
+                return game::InverseSymmetry(s);
+            }
+        }
+        return State_t::SYMMETRIES;
+    };
+    const auto& root = m_pool[0];
+    if(const auto symmetry = match(root.m_state); symmetry != State_t::SYMMETRIES) {
+        return { 0, symmetry };
+    }
+    if(IsLeaf(0)) {
+        return { NOT_FOUND, 0 };
+    }
+    for(auto child = root.m_children; child < root.m_children + root.m_count; child++) {
+        if(IsLeaf(child)) {
+            continue;
+        }
+        const auto& node = m_pool[child];
+        for(auto grandchild = node.m_children; grandchild < node.m_children + node.m_count; grandchild++) {
+            if(const auto symmetry = match(m_pool[grandchild].m_state); symmetry != State_t::SYMMETRIES) {
+                return { grandchild, symmetry };
+            }
+        }
     }
+    return { NOT_FOUND, 0 };
 }
 
-void MCTS::BackupNegamax(Node* node, float reward) {
-    assert(node && "[ERROR] can't backup nullptr!");
-    node->m_reward += node->m_player == m_player? reward : -reward;
-    node->m_visits++;
+template<class Game_t>
+void BasicMCTS<Game_t>::Compact(Index_t index) {
+    // breadth-first order keeps the children of each node contiguous
+    m_relocations.clear();
+    m_relocations.push_back(Relocation { index });
+    for(size_t i = 0; i < m_relocations.size(); i++) {
+        auto& relocation = m_relocations[i];
+        const auto& node = m_pool[relocation.m_index];
+        relocation.m_state = node.m_state;
+        relocation.m_count = node.m_count;
+        relocation.m_player = node.m_player;
+        relocation.m_status = node.m_status.load(std::memory_order_relaxed);
+        relocation.m_proof = node.m_proof.load(std::memory_order_relaxed);
+        relocation.m_visits = m_visits[relocation.m_index].load(std::memory_order_relaxed);
+        relocation.m_reward = m_rewards[relocation.m_index].load(std::memory_order_relaxed);
+        if(m_raveEquivalence) {
+            relocation.m_amafVisits = m_amafVisits[relocation.m_index].load(std::memory_order_relaxed);
+            relocation.m_amafReward = m_amafRewards[relocation.m_index].load(std::memory_order_relaxed);
+        }
+        relocation.m_children = static_cast<Index_t>(m_relocations.size());
+        const auto first = node.m_children;
+        const auto count = node.m_count;
+        // `relocation` may be invalidated here
+        for(auto child = first; child < first + count; child++) {
+            m_relocations.push_back(Relocation { child });
+        }
+    }
 
-    if(node->m_parent) {
-        this->BackupNegamax(node->m_parent, reward);
+    this->ResetPools();
+    this->AcquireNodes(m_relocations.size());
+    for(size_t i = 0; i < m_relocations.size(); i++) {
+        const auto& relocation = m_relocations[i];
+        auto& node = m_pool[i];
+        node.m_state = relocation.m_state;
+        node.m_children = relocation.m_children;
+        node.m_count = relocation.m_count;
+        node.m_player = relocation.m_player;
+        node.m_status.store(relocation.m_status, std::memory_order_relaxed);
+        node.m_proof.store(relocation.m_proof, std::memory_order_relaxed);
+        m_visits[i].store(relocation.m_visits, std::memory_order_relaxed);
+        m_rewards[i].store(relocation.m_reward, std::memory_order_relaxed);
+        if(m_raveEquivalence) {
+            m_amafVisits[i].store(relocation.m_amafVisits, std::memory_order_relaxed);
+            m_amafRewards[i].store(relocation.m_amafReward, std::memory_order_relaxed);
+        }
     }
 }
 
-size_t MCTS::Run(State_t board) {
-    m_pool.Reset();
+template<class Game_t>
+size_t BasicMCTS<Game_t>::Run(State_t board, const Deadline& deadline) {
     m_elapsed = 0ull;
+    m_deadline = deadline.Capped(m_timeLimit);
 
-    uint64_t simulationLimit { 5000 };
+    std::atomic<int64_t> simulationLimit { static_cast<int64_t>(m_iterations) };
     
-    // initialize root node
-    const auto root = m_pool.Acquire();
-    *root = Node{};
-    root->m_state = board;
-    // init with opponent
-    root->m_player = this->GetNextPlayer(m_player);
-
-    // Iterate an algorithm
-    while(simulationLimit > 0 
-        && m_elapsed < m_timeLimit 
-        && m_treeSize < m_pool.Capacity()
-    ) {
-        const auto start = std::chrono::system_clock::now();
-        simulationLimit--;
-        auto selected = this->Select(root);
-        if(!this->IsTerminal(selected->m_state)) {
-            assert(IsLeaf(selected) && "[ERROR] Unexpected node was selected!");
-            this->Expand(selected);
-            assert(!selected->m_children.empty() && "[ERROR] problems with expand function!");
-            // select random value base on random tree-policy
-            const auto randomChild = m_engine() % selected->m_children.size();
-            selected = selected->m_children[randomChild];
-        }
+    const Index_t root { 0u };
+    // the root may be the position symmetric to the board
+    size_t symmetry { 0 };
+    if(const auto [found, image] = this->FindNode(board); found != NOT_FOUND) {
+        this->Compact(found);
+        m_reused = m_pool.Size();
+        symmetry = image;
+    }
+    else {
+        // initialize root node
+        this->ResetPools();
+        this->AcquireNodes(1);
+        // init with opponent
+        this->InitNode(root, board, Game_t::GetNextPlayer(m_player), Game_t::GetState(board).first);
+        m_reused = 0;
+    }
+    assert(m_pool[root].m_player == Game_t::GetNextPlayer(m_player) && "The root must be the opponent's node");
 
-        const auto reward = this->Simulate(selected);
-        this->BackupNegamax(selected, reward);
-        // update timer
-        const auto end = std::chrono::system_clock::now();
-        const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
-        m_elapsed += static_cast<uint64_t>(elapsed);
+    // Iterate an algorithm: the current thread is the first worker
+    std::vector<std::thread> threads;
+    threads.reserve(m_workers.size() - 1);
+    for(size_t i = 1; i < m_workers.size(); i++) {
+        threads.emplace_back([this, i, &simulationLimit]() {
+            this->Search(m_workers[i], simulationLimit);
+        });
+    }
+    this->Search(m_workers.front(), simulationLimit);
+    for(auto& thread: threads) {
+        thread.join();
+    }
+    for(const auto& worker: m_workers) {
+        m_elapsed = std::max(m_elapsed, worker.m_elapsed);
     }
 
-    std::cerr << "Visits: " << root->m_visits << "; Reward: " << root->m_reward << '\n';
+    this->CollectStats();
     // chose best action
-    auto max = std::max_element(root->m_children.cbegin(), root->m_children.cend(), [](Node* lhs, Node*rhs) {
-        return lhs->m_reward < rhs->m_reward;
-    });
-    std::cerr << "visits-rewards: ";
-    for(auto node: root->m_children) {
-        std::cerr << "{" << node->m_visits << ", " << node->m_reward << "}, ";
-    }
-    std::cerr << '\n';
-
-    assert(max != root->m_children.cend());
-    auto state = (*max)->m_state;
-
-    size_t bestMove = 0;
-    for(size_t i = 0; i < State_t::SIZE; i++) {
-        auto row = i / 3;
-        auto col = i % 3;
-        if(board.at(row, col) != state.at(row, col)) {
-            bestMove = i;
-            break;
+    const auto first = m_pool[root].m_children;
+    const auto last = first + m_pool[root].m_count;
+    assert(first < last && "[ERROR] the root isn't expanded!");
+    // a proven win is taken at once, proven losses are avoided if possible,
+    // the rest are compared by the reward
+    const auto rank = [this](Index_t child) {
+        const auto proof = m_pool[child].m_proof.load(std::memory_order_relaxed);
+        return proof == Node::WIN? 2 : proof == Node::LOSS? 0 : 1;
+    };
+    auto max = first;
+    for(auto child = first; child < last; child++) {
+        const auto lhs = rank(max);
+        const auto rhs = rank(child);
+        if(lhs < rhs || (lhs == rhs && rhs != 2
+            && m_rewards[max].load(std::memory_order_relaxed) < m_rewards[child].load(std::memory_order_relaxed))
+        ) {
+            max = child;
+        }
+    }
+
+    // the only cell which is free at the root but not in the child's state,
+    // mapped to the board
+    const auto cell = game::details::LowestBit(m_pool[root].m_state.freeCells() & ~m_pool[max].m_state.freeCells());
+    return game::TransformCell<State_t>(cell, symmetry);
+}
+
+template<class Game_t>
+void BasicMCTS<Game_t>::CollectStats() noexcept {
+    m_stats = Stats{};
+    for(const auto& worker: m_workers) {
+        const auto& stats = worker.m_stats;
+        m_stats.m_iterations += worker.m_iterations;
+        for(size_t phase = 0; phase < PHASES; phase++) {
+            m_stats.m_calls[phase] += stats.m_calls[phase];
+            m_stats.m_ticks[phase] += stats.m_ticks[phase];
         }
+        m_stats.m_samples += stats.m_samples;
+        m_stats.m_depthSum += stats.m_depthSum;
+        m_stats.m_maxDepth = std::max(m_stats.m_maxDepth, stats.m_maxDepth);
+        m_stats.m_children += stats.m_children;
     }
-    return bestMove;
+    m_stats.m_poolSize = m_pool.Size();
+    m_stats.m_poolCapacity = m_pool.Capacity();
+    m_stats.m_poolCommitted = m_pool.Committed() + m_visits.Committed() + m_rewards.Committed()
+        + m_amafVisits.Committed() + m_amafRewards.Committed();
+    m_stats.m_rootVisits = m_visits[0].load(std::memory_order_relaxed);
+    m_stats.m_rootReward = m_rewards[0].load(std::memory_order_relaxed);
+    m_stats.m_rootProof = static_cast<Node::Proof>(m_pool[0].m_proof.load(std::memory_order_relaxed));
 }
 
-void MCTS::Print(std::ostream& os) const {
-    os << "Allocated: " << m_pool.Size() << " nodes\n";
+template<class Game_t>
+uint64_t BasicMCTS<Game_t>::Playouts() const noexcept {
+    uint64_t iterations { 0 };
+    for(const auto& worker: m_workers) {
+        iterations += worker.m_iterations;
+    }
+    return iterations * m_playouts;
+}
+
+template<class Game_t>
+void BasicMCTS<Game_t>::Print(std::ostream& os) const {
+    // the root (or the reused subtree) isn't allocated by workers
+    uint64_t allocated { std::max<uint64_t>(m_reused, 1) };
+    for(const auto& worker: m_workers) {
+        allocated += worker.m_allocated;
+    }
+    os << "Allocated: " << allocated << " nodes\n";
+    os << "Reused: " << m_reused << " nodes\n";
     os << "Elapsed time: " << m_elapsed / 1'000.f << " ms\n";
+    for(size_t i = 0; i < m_workers.size(); i++) {
+        const auto& worker = m_workers[i];
+        os << "Worker #" << i << ": iterations: " << worker.m_iterations 
+            << ", allocated: " << worker.m_allocated << " nodes"
+            << ", elapsed time: " << worker.m_elapsed / 1'000.f << " ms\n";
+    }
+    const char* proofs[] = { "unknown", "win", "loss", "draw" };
+    os << "Root: visits: " << m_stats.m_rootVisits << ", reward: " << m_stats.m_rootReward 
+        << ", proven: " << proofs[m_stats.m_rootProof] << " (for the opponent)\n";
+    os << "Pool: " << m_stats.m_poolSize << " / " << m_stats.m_poolCapacity << " nodes"
+        << ", committed: " << m_stats.m_poolCommitted / 1024 << " KB\n";
+#ifdef MCTS_INSTRUMENTATION
+    const auto iterations = std::max<uint64_t>(m_stats.m_iterations, 1);
+    const auto expansions = std::max<uint64_t>(m_stats.m_calls[EXPAND], 1);
+    const auto samples = std::max<uint64_t>(m_stats.m_samples, 1);
+    os << "Depth: average: " << static_cast<float>(m_stats.m_depthSum) / iterations 
+        << ", max: " << m_stats.m_maxDepth
+        << "; branching: " << static_cast<float>(m_stats.m_children) / expansions << "\n";
+    const char* names[PHASES] = { "select", "expand", "simulate", "backup" };
+    os << "Ticks per iteration (" << m_stats.m_samples << " sampled):";
+    for(size_t phase = 0; phase < PHASES; phase++) {
+        os << " " << names[phase] << ": " << m_stats.m_ticks[phase] / samples
+            << " (" << m_stats.m_calls[phase] << " calls)";
+    }
+    os << "\n";
+#endif
 }
 
+template class BasicMCTS<TicTacToe>;
+template class BasicMCTS<BasicGame<game::Board4x4>>;
+template class BasicMCTS<BasicGame<game::Board7x7>>;
+template class BasicMCTS<BasicGame<game::Gomoku>>;
+
+} // namespace solution
 
-} // namespace solution
\ No newline at end of file
+void TestMCTS() {
+    using game::Board;
+    std::cerr << "Test MCTS with merged symmetric children...\n";
+    // 'x' plays at random, the tree of 'o' is reused between the moves: the move of 'x'
+    // is often symmetric to the one in the tree, so the chosen move is mapped back to the board
+    solution::Xorshift32 random { 5u };
+    for(size_t i = 0; i < 50; i++) {
+        solution::MCTS mcts { 1'000'000'000, 2'000, 100'000, 1, 1, 1, 0, true };
+        Board board;
+        for(uint8_t player = 0; game::GetGameState(board).first == game::State::ONGOING; player ^= 1) {
+            const game::Cells cells { board.freeCells() };
+            size_t move { 0 };
+            if(player == 0) {
+                move = solution::RandomCell(cells, random);
+            }
+            else {
+                move = mcts.Run(board);
+                assert(board.at(move) == game::Cell::FREE && "The move must be legal");
+                [[maybe_unused]] auto best = -1;
+                for(const auto cell: cells) {
+                    best = std::max(best, solution::MoveValue(board, player, cell));
+                }
+                assert(solution::MoveValue(board, player, move) == best && "The move must keep the best result");
+            }
+            board.assign(move, solution::TicTacToe::Mark(player));
+        }
+    }
+    std::cerr << "Complete test.\n";
+}
@@ -4,88 +4,299 @@
 #include "Board.hpp"
 #include "ElementPool.hpp"
 #include "Solver.hpp"
+#include "Playout.hpp"
+#include "CycleClock.hpp"
+#include "Random.hpp"
 
 #include <cstdint>
-#include <random>
+#include <atomic>
+#include <vector>
+#include <mutex>
+#include <utility>
 
 namespace solution {
 
-// TODO: remove parent from the node
-// TODO: get rid of the fucking std::vector
-struct Node final {
-    Solver::State_t m_state {};
-    std::vector<Node*> m_children {}; 
-    Node*           m_parent { nullptr };
-    uint32_t        m_visits { 0u };
-    float           m_reward { 0.f };
+/**
+ * Nodes refer to each other by indices in the pool. 
+ * Statistics (visits & rewards) are stored separately, see `BasicMCTS::m_visits`.
+ */
+struct Node {
+    enum Status: uint8_t { LEAF, EXPANDING, EXPANDED };
+    // game-theoretic value for `m_player` (the player who made the move) once it's proven
+    enum Proof: uint8_t { UNKNOWN, WIN, LOSS, DRAW };
+    using Index_t = uint32_t;
+};
+
+template<class State_t>
+struct BasicNode final : Node {
+    State_t         m_state {};
+    // children are allocated as one block: [m_children, m_children + m_count)
+    Index_t         m_children { 0u };
+    uint8_t         m_count { 0u };
     uint8_t         m_player { 0 };
+    // children can be read only when the node is `EXPANDED`
+    std::atomic<uint8_t> m_status { LEAF };
+    std::atomic<uint8_t> m_proof { UNKNOWN };
 };
 
 /**
  * MCTS doesn't evaluate each node, only leaf 
  * Constrains: time & memory
  */
-class MCTS final : public Solver {
+template<class Game_t>
+class BasicMCTS final : public BasicSolver<typename Game_t::State_t> {
 public:
+    using Solver_t = BasicSolver<typename Game_t::State_t>;
+    using typename Solver_t::State_t;
+
+    enum Phase: uint8_t { SELECT, EXPAND, SIMULATE, BACKUP, PHASES };
+
+    /**
+     * Statistics of the last `Run`.
+     * Phase counters are collected only when built with `MCTS_INSTRUMENTATION`,
+     * the phases are timed once per `SAMPLE_PERIOD` iterations of each worker.
+     */
+    struct Stats {
+        uint64_t    m_iterations { 0 };
+        // [phase] - number of calls
+        uint64_t    m_calls[PHASES] {};
+        // number of timed iterations
+        uint64_t    m_samples { 0 };
+        // [phase] - `CycleClock` ticks spent by the timed iterations
+        uint64_t    m_ticks[PHASES] {};
+        // depth of the selected nodes: sum over iterations and maximum
+        uint64_t    m_depthSum { 0 };
+        size_t      m_maxDepth { 0 };
+        // number of children added by expansions
+        uint64_t    m_children { 0 };
+        // pool occupancy after the search
+        size_t      m_poolSize { 0 };
+        size_t      m_poolCapacity { 0 };
+        size_t      m_poolCommitted { 0 };
+        // statistics of the root after the search
+        uint32_t    m_rootVisits { 0 };
+        float       m_rootReward { 0.f };
+        Node::Proof m_rootProof { Node::UNKNOWN };
+    };
+
+    // one of this number of iterations is timed
+    static constexpr uint64_t SAMPLE_PERIOD { 16 };
 
     /**
      * @param timeLimit     (stop condition) timelimit for algorithm in microseconds
      * @param iterations    (stop condition) limit on number of algorithm's iterations (main while loop)
-     * @param treeSize      (stop condition) max number of nodes algorithm can add to the tree
+     * @param treeSize      (stop condition) max number of nodes algorithm can add to the tree, the node pools are sized by it
      * @param player        Define player identity for AI (next action in game is performed by htis player).
-     *                      Belongs to integer range [0, 1] inclusive
-     * @param playerMapping Maps player to board mark!
+     *                      Belongs to integer range [0, 1] inclusive, mapped to the mark by `Game_t`
+     * @param threads       Number of workers sharing the tree (tree parallelization with virtual loss)
+     * @param playouts      Number of random games played from each leaf (leaf parallelization),
+     *                      the averaged reward is backed up
+     * @param raveEquivalence  RAVE: number of visits of the node when its own and all-moves-as-first
+     *                      values have equal weights in the selection, 0 disables RAVE
+     * @param symmetric     Expand one move of each group of moves symmetric by the symmetries
+     *                      of the node (see `game::UniqueMoves`): their positions have the same value,
+     *                      so they share one child and its statistics
     */
-    MCTS(uint64_t timeLimit
+    BasicMCTS(uint64_t timeLimit
         , uint64_t iterations
         , uint64_t treeSize
         , uint8_t player
-        , Mapping_t && playerMapping
+        , size_t threads = 1
+        , size_t playouts = 1
+        , uint32_t raveEquivalence = 0
+        , bool symmetric = false
     );
 
     /**
-     * Run MCTS algorithm for the given board state
+     * Run MCTS algorithm for the given board state. 
+     * The subtree of the previous search is reused when the board was reachable from its root
      * @param board is a current game state
+     * @param deadline is checked along with the time limit, the search stops at the earlier one
      * @return the best move. To extract row and col do the following:
-     * - row = return_value / 3; 
-     * - col = return_value % 3
+     * - row = return_value / State_t::COLS; 
+     * - col = return_value % State_t::COLS
      */
-    size_t Run(State_t board) override;
+    size_t Run(State_t board, const Deadline& deadline) override;
+
+    using Solver_t::Run;
 
     void Print(std::ostream& os) const override;
 
+    uint64_t Nodes() const noexcept override {
+        return m_stats.m_iterations;
+    }
+
+    // number of random games played by the last `Run`
+    uint64_t Playouts() const noexcept;
+
+    const Stats& GetStats() const noexcept {
+        return m_stats;
+    }
+
 private:
+    using Solver_t::m_player;
+    using Solver_t::m_elapsed;
+
+    using Index_t = Node::Index_t;
+    using Playout_t = BasicPlayout<State_t>;
+
+    // state of the thread running the algorithm's iterations
+    struct Worker {
+        Xorshift32  m_random{};
+        Playout_t   m_playout{};
+        // statistics of the games played by the last simulation (RAVE)
+        typename Playout_t::Amaf m_amaf{};
+        bool        m_hasAmaf { false };
+        // slice of the pool owned by this worker
+        Index_t     m_slice { 0u };
+        size_t      m_sliceSize { 0 };
+        // nodes from the root to the selected one (there is no parent in the node)
+        Index_t     m_path[State_t::SIZE + 1] {};
+        size_t      m_depth { 0 };
+        // statistics of the last `Run`:
+        uint64_t    m_iterations { 0 };
+        uint64_t    m_allocated { 0 };
+        uint64_t    m_elapsed { 0 };
+        Stats       m_stats {};
+    };
+
+    // the deadline (time limit) is checked once per this number of iterations
+    static constexpr uint64_t CHECK_PERIOD { 16 };
+
+    // number of nodes a worker takes from the pool at once
+    static constexpr size_t SLICE_SIZE { 64 * State_t::SIZE };
+
+    // the tree stops growing at `treeSize` nodes but each worker may still take one more slice
+    static constexpr size_t PoolCapacity(uint64_t treeSize, size_t threads) noexcept {
+        return static_cast<size_t>(treeSize) + threads * SLICE_SIZE;
+    }
+
+    // reward for the draw, the win costs 1, the loss - 0
+    static constexpr float DRAW_REWARD { 0.3f };
+
+    static constexpr Index_t NOT_FOUND { ~Index_t{} };
+
+    // copy of the node used while the tree is compacted
+    struct Relocation {
+        Index_t     m_index { 0u };
+        State_t     m_state {};
+        Index_t     m_children { 0u };
+        uint8_t     m_count { 0u };
+        uint8_t     m_player { 0u };
+        uint8_t     m_status { Node::LEAF };
+        uint8_t     m_proof { Node::UNKNOWN };
+        uint32_t    m_visits { 0u };
+        float       m_reward { 0.f };
+        uint32_t    m_amafVisits { 0u };
+        float       m_amafReward { 0.f };
+    };
 
-    void Expand(Node* node);
+    // run iterations until one of stop conditions is reached
+    void Search(Worker& worker, std::atomic<int64_t>& simulationLimit);
+
+    void Expand(Index_t node, Worker& worker);
    
-    Node* Select(Node* node) const noexcept;
+    // @return the selected node which is also the last one in the worker's path
+    Index_t Select(Worker& worker) noexcept;
+
+    float Simulate(Index_t node, Worker& worker) const;
+
+    void Backup(const Worker& worker, float reward);
 
-    float Simulate(Node* node);
+    void BackupNegamax(const Worker& worker, float reward);
+
+    /**
+     * RAVE: update all-moves-as-first statistics of the children of the worker's path nodes.
+     * The move of the child counts when its player occupied the cell by the end of a simulated game
+     */
+    void BackupAmaf(const Worker& worker);
 
-    void Backup(Node* node, float reward);
+    /**
+     * MCTS-Solver: prove the nodes of the worker's path from the leaf upward by minimax rules.
+     * The node is lost when any child is won (by the opponent),
+     * it's a draw or won when all children are proven.
+     */
+    void Prove(const Worker& worker) noexcept;
 
-    void BackupNegamax(Node* node, float reward);
+    // @return value of the node proven by its children or `UNKNOWN`
+    Node::Proof ProveByChildren(Index_t node) const noexcept;
 
-    bool IsLeaf(const Node* node) const noexcept;
+    bool IsLeaf(Index_t node) const noexcept;
 
     // upper confidence bound of the tree
-    float UCT(const Node* node, const Node* parent) const noexcept;
+    float UCT(Index_t node, float logParentVisits) const noexcept;
+
+    // reward (loss) for the node's player temporarily added while the node
+    // is being evaluated, so other workers prefer different paths
+    float VirtualLoss(Index_t node) const noexcept;
+
+    void ApplyVirtualLoss(Index_t node) noexcept;
+
+    // thread-safe: acquire the block of nodes along with their statistics
+    // @return index of the first node in the block
+    Index_t AcquireNodes(size_t count);
+
+    void ResetPools() noexcept;
+
+    // pool's nodes are reused so they must be reinitialized
+    // @param result state of the game: terminal nodes are proven at once
+    void InitNode(Index_t node, State_t state, uint8_t player, game::State result) noexcept;
+
+    /**
+     * Look for the board among the root of the previous search and its grandchildren
+     * (the positions where AI makes the next move), with merged symmetric children
+     * the position symmetric to the board is looked for as well
+     * @return index of the found node or `NOT_FOUND` and the symmetry which maps
+     * the cells of the node's position to the cells of the board
+     */
+    std::pair<Index_t, size_t> FindNode(State_t board) const noexcept;
+
+    // gather statistics of the workers, the pool and the root into `m_stats`
+    void CollectStats() noexcept;
+
+    // move the subtree of the node to the beginning of the pool (the node becomes the root)
+    // reclaiming the rest of the pool
+    void Compact(Index_t node);
 
 private:
     // Time constrain for the algorithm (in microseconds)
     // Default value: 0.1s
     const uint64_t m_timeLimit { 100'000 }; 
+    // of the current `Run`: the caller's deadline limited by `m_timeLimit`
+    Deadline m_deadline{};
     const uint64_t m_iterations { 2000 };
     const uint64_t m_treeSize { 10'000 };
+    const size_t m_playouts { 1 };
+    const uint32_t m_raveEquivalence { 0 };
+    const bool m_symmetric { false };
 
-    ElementPool<Node> m_pool{};
-    std::mt19937 m_engine{};
+    ElementPool<BasicNode<State_t>> m_pool;
+    // statistics of the nodes (indexed as the pool) are shared by all workers,
+    // children's values are contiguous so the selection scans them sequentially
+    ElementPool<std::atomic<uint32_t>> m_visits;
+    ElementPool<std::atomic<float>> m_rewards;
+    // all-moves-as-first statistics (used only with RAVE): the number of games and the sum of rewards
+    ElementPool<std::atomic<uint32_t>> m_amafVisits;
+    ElementPool<std::atomic<float>> m_amafRewards;
+    // keeps the pools above in sync
+    std::mutex m_poolMutex;
+    std::vector<Worker> m_workers{};
+    // nodes of the reused subtree in breadth-first order, kept to not reallocate it
+    std::vector<Relocation> m_relocations{};
+    // number of nodes reused by the last `Run`
+    size_t m_reused { 0 };
+    Stats m_stats {};
 };
 
-inline bool MCTS::IsLeaf(const Node* node) const noexcept {
-    return node->m_children.empty();
+template<class Game_t>
+inline bool BasicMCTS<Game_t>::IsLeaf(Index_t node) const noexcept {
+    return m_pool[node].m_status.load(std::memory_order_acquire) != Node::EXPANDED;
 }
 
+using MCTS = BasicMCTS<TicTacToe>;
+
 } // namespace solution
 
+void TestMCTS();
+
 #endif // MCTS_HPP
\ No newline at end of file
@@ -2,39 +2,42 @@
 #include <cassert>
 #include <algorithm>
 #include <chrono>
+#include <cstdint>
+#include <thread>
 
 namespace solution {
 
-Minimax::Minimax(
-    uint8_t player
-    , Mapping_t && playerMapping
-) 
-    : Solver { player, std::move(playerMapping) }
+template<class Game_t>
+BasicMinimax<Game_t>::BasicMinimax(uint8_t player)
+    : Solver_t { player }
 {
     assert(m_player <= 1);
 }
 
-size_t Minimax::Run(State_t board) {
-    using game::Board;
+template<class Game_t>
+size_t BasicMinimax<Game_t>::Run(State_t board, const Deadline& deadline) {
     m_expanded = 0u;
+    m_deadline = deadline;
+    m_stopped = false;
     const auto start = std::chrono::system_clock::now();
     // Look through all possible moves
     // and choose the one with best heuristic value.
     auto bestHeuristic { -10000.f };
-    size_t bestMove { 0 };
-    for(size_t i = 0; i < Board::SIZE; i++) {
-        const auto row = i / 3;
-        const auto col = i % 3;
-        if (board.at(row, col) == Board::Cell::FREE) {
-            m_expanded++;
-            board.assign(row, col, m_playerMapping(m_player));
-            auto heuristic { this->Apply(board, 8, false) };
-            if (bestHeuristic < heuristic) {
-                bestHeuristic = heuristic;
-                bestMove = i;
-            }
-            board.clear(row, col);
+    // the first free cell when the deadline doesn't let to search any move
+    size_t bestMove { game::details::LowestBit(board.freeCells()) };
+    const auto mark = Game_t::Mark(m_player);
+    for(const auto i: game::Cells { board.freeCells() }) {
+        m_expanded++;
+        board.assign(i, mark);
+        auto heuristic { this->Apply(board, i, static_cast<int>(State_t::SIZE) - 1, false) };
+        if (m_stopped) {
+            break;
         }
+        if (bestHeuristic < heuristic) {
+            bestHeuristic = heuristic;
+            bestMove = i;
+        }
+        board.clear(i);
     }
     const auto end = std::chrono::system_clock::now();
     const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
@@ -42,139 +45,345 @@ size_t Minimax::Run(State_t board) {
     return bestMove;
 }
 
-float Minimax::Apply(State_t target, int depth, bool isMaximizingPlayer) {
-    using game::Board;
+template<class Game_t>
+float BasicMinimax<Game_t>::Apply(State_t target, size_t lastMove, int depth, bool isMaximizingPlayer) {
 
-    if (!depth || this->IsTerminal(target)) {
-        return this->GetHeuristic(target, depth);
+    if (m_expanded % CHECK_PERIOD == 0 && !m_stopped && m_deadline.IsExpired()) {
+        m_stopped = true;
+    }
+    if (m_stopped) {
+        return 0.f;
+    }
+    const auto result = Game_t::GetState(target, lastMove);
+    if (!depth || result.first != game::State::ONGOING) {
+        return this->GetHeuristic(result, depth);
     }
     if (isMaximizingPlayer) {
         auto heuristic = -10000.f;
-        for(size_t i = 0; i < game::Board::SIZE; i++) {
-            const auto row = i / 3;
-            const auto col = i % 3;
-            if(target.at(row, col) == Board::Cell::FREE) {
-                m_expanded++;
-                target.assign(row, col, m_playerMapping(m_player));
-                heuristic = std::max(heuristic, this->Apply(target, depth - 1, false));
-                target.clear(row, col);
-            }
+        const auto mark = Game_t::Mark(m_player);
+        for(const auto i: game::Cells { target.freeCells() }) {
+            m_expanded++;
+            target.assign(i, mark);
+            heuristic = std::max(heuristic, this->Apply(target, i, depth - 1, false));
+            target.clear(i);
         }
         return heuristic;
     }
     else {
         auto heuristic = 10000.f;
-        for(size_t i = 0; i < game::Board::SIZE; i++) {
-            const auto row = i / 3;
-            const auto col = i % 3;
-            if(target.at(row, col) == Board::Cell::FREE) {
-                m_expanded++;
-                target.assign(row, col, m_playerMapping(GetNextPlayer(m_player)));
-                heuristic = std::min(heuristic, this->Apply(target, depth - 1, true));
-                target.clear(row, col);
-            }
+        const auto mark = Game_t::Mark(Game_t::GetNextPlayer(m_player));
+        for(const auto i: game::Cells { target.freeCells() }) {
+            m_expanded++;
+            target.assign(i, mark);
+            heuristic = std::min(heuristic, this->Apply(target, i, depth - 1, true));
+            target.clear(i);
         }
         return heuristic;
     }
 }
 
-void Minimax::Print(std::ostream& os) const {
+template<class Game_t>
+void BasicMinimax<Game_t>::Print(std::ostream& os) const {
     os << "Look through: " << m_expanded << " nodes\n";
     os << "Elapsed time: " << m_elapsed / 1'000.f << " ms\n";
 }
 
-size_t AlphaBettaMinimax::Run(State_t board) {
-    using game::Board;
+template<class Game_t>
+BasicAlphaBettaMinimax<Game_t>::BasicAlphaBettaMinimax(
+    uint8_t player
+    , uint64_t timeLimit
+    , size_t threads
+)
+    : Minimax_t { player }
+    , m_timeLimit { timeLimit }
+    , m_searchers(threads)
+{
+    assert(threads > 0 && "At least one thread must search");
+    // the first searcher belongs to the thread calling `Run`
+    m_threads.reserve(threads - 1);
+    for(size_t i = 1; i < threads; i++) {
+        m_threads.emplace_back([this, i]() {
+            this->Loop(m_searchers[i]);
+        });
+    }
+}
+
+template<class Game_t>
+BasicAlphaBettaMinimax<Game_t>::~BasicAlphaBettaMinimax() {
+    {
+        std::lock_guard<std::mutex> lock { m_mutex };
+        m_stopped = true;
+    }
+    m_started.notify_all();
+    for(auto& thread: m_threads) {
+        thread.join();
+    }
+}
+
+template<class Game_t>
+void BasicAlphaBettaMinimax<Game_t>::Loop(Searcher& searcher) {
+    uint64_t round { 0 };
+    while(true) {
+        {
+            std::unique_lock<std::mutex> lock { m_mutex };
+            m_started.wait(lock, [this, round]() { return m_stopped || m_round != round; });
+            if(m_stopped) {
+                return;
+            }
+            round = m_round;
+        }
+        this->SearchRoot(searcher, m_board, m_moves, m_count);
+        {
+            std::lock_guard<std::mutex> lock { m_mutex };
+            m_running--;
+        }
+        m_finished.notify_one();
+    }
+}
+
+template<class Game_t>
+bool BasicAlphaBettaMinimax<Game_t>::IsTimeOver(const Searcher& searcher) noexcept {
+    // the first iteration is always completed to have a move
+    if (m_iteration > 1 && searcher.m_expanded % CHECK_PERIOD == 0 && m_deadline.IsExpired()) {
+        m_aborted.store(true, std::memory_order_relaxed);
+    }
+    return m_aborted.load(std::memory_order_relaxed);
+}
+
+template<class Game_t>
+size_t BasicAlphaBettaMinimax<Game_t>::Run(State_t board, const Deadline& deadline) {
 
     const auto start = std::chrono::system_clock::now();
-    m_expanded = 0u;
-    // Look through all possible moves
-    // and choose the one with best heuristic value.
-    auto bestHeuristic { -INF };
-    size_t bestMove { 0 };
-    for(size_t i = 0; i < game::Board::SIZE; i++) {
-        const auto row = i / 3;
-        const auto col = i % 3;
-        if (board.at(row, col) == Board::Cell::FREE) {
-            m_expanded++;
-            board.assign(row, col, m_playerMapping(m_player));
-            auto heuristic { this->Apply(board, 8, -INF, +INF, false) };
-            if (bestHeuristic < heuristic) {
-                bestHeuristic = heuristic;
-                bestMove = i;
+    m_deadline = m_timeLimit == UNLIMITED? deadline : deadline.Capped(m_timeLimit);
+    m_aborted = false;
+    m_completed = 0;
+    for(auto& searcher: m_searchers) {
+        searcher.m_table.Clear();
+        searcher.m_expanded = 0u;
+        std::fill(&searcher.m_killers[0][0], &searcher.m_killers[0][0] + sizeof(searcher.m_killers), static_cast<uint8_t>(State_t::SIZE));
+        std::fill(&searcher.m_history[0][0], &searcher.m_history[0][0] + State_t::SIZE * 2, 0u);
+    }
+
+    RootMove moves[State_t::SIZE];
+    size_t count { 0 };
+    for(const auto i: game::Cells { board.freeCells() }) {
+        moves[count++] = RootMove { i, 0.f };
+    }
+
+    size_t bestMove { count? moves[0].m_cell : 0 };
+    // deeper iterations than the number of free cells can't change the best move
+    const auto depth = std::min(MAX_DEPTH, static_cast<int>(count));
+    // without time limit shallow iterations are useless: the values depend on depth 
+    // so the transposition table can't reuse them
+    for(m_iteration = m_deadline.IsUnlimited()? depth : 1; m_iteration <= depth; m_iteration++) {
+        // the first move (principal variation) is searched alone to get the bound for the rest
+        m_alpha = -INF;
+        m_next = 0;
+        this->SearchRoot(m_searchers.front(), board, moves, 1);
+        if (m_aborted) {
+            break;
+        }
+        m_next = 1;
+        // the rest are shared with the helpers, unless there is nothing to share
+        if(m_threads.empty() || count < 3) {
+            this->SearchRoot(m_searchers.front(), board, moves, count);
+        }
+        else {
+            {
+                std::lock_guard<std::mutex> lock { m_mutex };
+                m_board = board;
+                m_moves = moves;
+                m_count = count;
+                m_running = m_threads.size();
+                m_round++;
+            }
+            m_started.notify_all();
+            this->SearchRoot(m_searchers.front(), board, moves, count);
+            std::unique_lock<std::mutex> lock { m_mutex };
+            m_finished.wait(lock, [this]() { return m_running == 0; });
+        }
+        if (m_aborted) {
+            break;
+        }
+        // choose the move with best heuristic value (the least cell among equal ones):
+        // worse moves just failed low, the equal ones are evaluated exactly
+        auto bestHeuristic { -INF };
+        for(size_t k = 0; k < count; k++) {
+            const auto& move = moves[k];
+            if (bestHeuristic < move.m_value || (bestHeuristic == move.m_value && move.m_cell < bestMove)) {
+                bestHeuristic = move.m_value;
+                bestMove = move.m_cell;
+            }
+        }
+        m_completed = m_iteration;
+        // principal variation goes first in the next iteration:
+        // stable insertion sort, `std::stable_sort` would allocate a buffer
+        for(size_t k = 1; k < count; k++) {
+            const auto move = moves[k];
+            auto j = k;
+            for(; j > 0 && moves[j - 1].m_value < move.m_value; j--) {
+                moves[j] = moves[j - 1];
             }
-            board.clear(row, col);
+            moves[j] = move;
         }
     }
+    m_expanded = 0u;
+    for(const auto& searcher: m_searchers) {
+        m_expanded += searcher.m_expanded;
+    }
     const auto end = std::chrono::system_clock::now();
     const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
     m_elapsed = static_cast<uint64_t>(elapsed);
     return bestMove;
 }
 
-float AlphaBettaMinimax::Apply(
-    State_t state
+template<class Game_t>
+void BasicAlphaBettaMinimax<Game_t>::SearchRoot(Searcher& searcher, State_t board, RootMove* moves, size_t count) {
+    for(auto k = m_next++; k < count && !m_aborted; k = m_next++) {
+        const auto i = moves[k].m_cell;
+        searcher.m_expanded++;
+        board.assign(i, Game_t::Mark(m_player));
+        // worse moves just fail low, the equal ones are evaluated exactly 
+        // (heuristic values are integers)
+        auto alpha = m_alpha.load(std::memory_order_relaxed);
+        const auto heuristic { this->Apply(searcher, board, i, m_iteration - 1, alpha - 1.f, +INF, false) };
+        board.clear(i);
+        moves[k].m_value = heuristic;
+        while (alpha < heuristic && !m_alpha.compare_exchange_weak(alpha, heuristic, std::memory_order_relaxed)) {}
+    }
+}
+
+template<class Game_t>
+float BasicAlphaBettaMinimax<Game_t>::Apply(
+    Searcher& searcher
+    , State_t state
+    , size_t lastMove
     , int depth
     , float alpha
     , float betta
     , bool isMaximizingPlayer
 ) {
-    using game::Board;
+    using Bound = typename Table_t::Bound;
 
+    if (this->IsTimeOver(searcher)) {
+        return 0.f;
+    }
+    if (const auto result = Game_t::GetState(state, lastMove); !depth || result.first != game::State::ONGOING) {
+        return this->GetHeuristic(result, depth);
+    }
 
-    if (!depth || this->IsTerminal(state)) {
-        return this->GetHeuristic(state, depth);
+    // all symmetric boards share the same entry
+    const auto [canonical, symmetry] = game::Canonical(state);
+    const auto initialAlpha = alpha;
+    const auto initialBetta = betta;
+    // move to try first: the best one found previously for this position
+    // (it also follows the principal variation of the previous iteration)
+    size_t firstMove { State_t::SIZE };
+    if (auto entry = searcher.m_table.Find(canonical); entry && entry->m_depth == depth) {
+        switch(entry->m_bound) {
+            case Bound::EXACT: return entry->m_value;
+            case Bound::LOWER: alpha = std::max(alpha, entry->m_value); break;
+            case Bound::UPPER: betta = std::min(betta, entry->m_value); break;
+            default: break;
+        }
+        if(alpha >= betta) {
+            return entry->m_value;
+        }
+        firstMove = game::TransformCell<State_t>(entry->m_move, game::InverseSymmetry(symmetry));
     }
-    if (isMaximizingPlayer) {
-        float heuristic = -INF;
-        for(size_t i = 0; i < game::Board::SIZE; i++) {
-            const auto row = i / 3;
-            const auto col = i % 3;
-            if(state.at(row, col) == Board::Cell::FREE) {
-                m_expanded++;
-                state.assign(row, col, m_playerMapping(m_player));
-                heuristic = std::max(heuristic, this->Apply(state, depth - 1, alpha, betta, false));
-                alpha = std::max(heuristic, alpha);
-                if(alpha >= betta) {
-                    break;
-                }
-                state.clear(row, col);
-            }
+    else if (entry) {
+        // the value of the other depth can't be used but its move is still a good guess
+        firstMove = game::TransformCell<State_t>(entry->m_move, game::InverseSymmetry(symmetry));
+    }
+
+    // order moves: the table's move, killers, then by history
+    const auto ply = m_iteration - depth;
+    auto& killers = searcher.m_killers[ply];
+    auto& history = searcher.m_history[isMaximizingPlayer];
+    size_t moves[State_t::SIZE];
+    uint32_t scores[State_t::SIZE];
+    size_t count { 0 };
+    for(const auto i: game::Cells { state.freeCells() }) {
+        const uint32_t score = i == firstMove? UINT32_MAX 
+            : i == killers[0]? UINT32_MAX - 1 
+            : i == killers[1]? UINT32_MAX - 2 
+            : history[i];
+        // insertion sort: the order of equal moves is kept
+        auto k = count++;
+        for(; k > 0 && scores[k - 1] < score; k--) {
+            moves[k] = moves[k - 1];
+            scores[k] = scores[k - 1];
         }
-        return heuristic;
+        moves[k] = i;
+        scores[k] = score;
     }
-    else {
-        float heuristic = INF;
-        for(size_t i = 0; i < game::Board::SIZE; i++) {
-            const auto row = i / 3;
-            const auto col = i % 3;
-            if(state.at(row, col) == Board::Cell::FREE) {
-                m_expanded++;
-                state.assign(row, col, m_playerMapping(GetNextPlayer(m_player)));
-                heuristic = std::min(heuristic, this->Apply(state, depth - 1, alpha, betta, true));
-                betta = std::min(heuristic, betta);
-                if(betta <= alpha) {
-                    break;
-                }
-                state.clear(row, col);
+
+    const auto mark = Game_t::Mark(isMaximizingPlayer? m_player : Game_t::GetNextPlayer(m_player));
+    float heuristic = isMaximizingPlayer? -INF : INF;
+    size_t bestMove { moves[0] };
+    for(size_t k = 0; k < count; k++) {
+        const auto i = moves[k];
+        searcher.m_expanded++;
+        state.assign(i, mark);
+        const auto value = this->Apply(searcher, state, i, depth - 1, alpha, betta, !isMaximizingPlayer);
+        state.clear(i);
+        if (m_aborted) {
+            return 0.f;
+        }
+        if (isMaximizingPlayer? heuristic < value : heuristic > value) {
+            heuristic = value;
+            bestMove = i;
+        }
+        if (isMaximizingPlayer) {
+            alpha = std::max(heuristic, alpha);
+        }
+        else {
+            betta = std::min(heuristic, betta);
+        }
+        if(alpha >= betta) {
+            if(killers[0] != i) {
+                killers[1] = killers[0];
+                killers[0] = static_cast<uint8_t>(i);
             }
+            history[i] += static_cast<uint32_t>(depth * depth);
+            break;
         }
-        return heuristic;
     }
+
+    const auto bound = heuristic <= initialAlpha? Bound::UPPER 
+        : heuristic >= initialBetta? Bound::LOWER 
+        : Bound::EXACT;
+    searcher.m_table.Store(canonical, heuristic, bound, depth, game::TransformCell<State_t>(bestMove, symmetry));
+    return heuristic;
 }
 
+template<class Game_t>
+void BasicAlphaBettaMinimax<Game_t>::Print(std::ostream& os) const {
+    Minimax_t::Print(os);
+    os << "Completed depth: " << m_completed << "\n";
+}
 
-float Minimax::GetHeuristic(State_t state, int depth) const noexcept {
-    using State = game::Board::State;
+template<class Game_t>
+float BasicMinimax<Game_t>::GetHeuristic(std::pair<game::State, game::Cell> result, int depth) const noexcept {
+    using game::State;
 
     int score = 0;
-    auto result = game::GetGameState(state);
     switch(result.first) {
         case State::ONGOING: case State::DRAW: score = depth; break;
-        case State::WIN: score = m_player == static_cast<uint8_t>(result.second)? 20 + depth: -20 - depth; break;
+        case State::WIN: score = Game_t::Mark(m_player) == result.second? WIN_SCORE + depth: -WIN_SCORE - depth; break;
         default: break;
     }
     return static_cast<float>(score);
 }
 
-}
\ No newline at end of file
+// the engines are built for these boards
+template class BasicMinimax<TicTacToe>;
+template class BasicMinimax<BasicGame<game::Board4x4>>;
+template class BasicMinimax<BasicGame<game::Board7x7>>;
+template class BasicMinimax<BasicGame<game::Gomoku>>;
+template class BasicAlphaBettaMinimax<TicTacToe>;
+template class BasicAlphaBettaMinimax<BasicGame<game::Board4x4>>;
+template class BasicAlphaBettaMinimax<BasicGame<game::Board7x7>>;
+template class BasicAlphaBettaMinimax<BasicGame<game::Gomoku>>;
+
+} // namespace solution
@@ -2,68 +2,216 @@
 #define MINIMAX_HPP_
 
 #include "Solver.hpp"
+#include "TranspositionTable.hpp"
+
+#include <chrono>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 namespace solution {
 
-class Minimax : public Solver {
+/**
+ * Plain minimax over the game `Game_t` (see `BasicGame`)
+ */
+template<class Game_t>
+class BasicMinimax : public BasicSolver<typename Game_t::State_t> {
 public:
+    using Solver_t = BasicSolver<typename Game_t::State_t>;
+    using typename Solver_t::State_t;
 
-    /**
-     * @param player identity (basicaly correspond to his turn in the game)
-     * @param mapping maps player index to cell
-     */
-    Minimax(uint8_t player, Mapping_t&& mapping);
+    // @param player identity (basicaly correspond to his turn in the game)
+    explicit BasicMinimax(uint8_t player);
 
     /**
      * Run minimax algorithm for the given board state
      * @param board is a current game state
+     * @param deadline when it expires the best of the completely searched root moves is returned
      * @return the best move. To extract row and col do the following:
-     * - row = return_value / 3; 
-     * - col = return_value % 3
+     * - row = return_value / State_t::COLS;
+     * - col = return_value % State_t::COLS
      */
-    size_t Run(State_t state) override;
+    size_t Run(State_t state, const Deadline& deadline) override;
+
+    using Solver_t::Run;
 
     void Print(std::ostream& os) const override;
 
+    uint64_t Nodes() const noexcept override {
+        return m_expanded;
+    }
+
+    // number of nodes opened by the last `Run`
+    size_t Expanded() const noexcept {
+        return m_expanded;
+    }
+
 protected:
+    using Solver_t::m_player;
+    using Solver_t::m_elapsed;
 
-    float GetHeuristic(State_t node, int depth) const noexcept;
+    /**
+     * @param result state of the game (see `game::GetGameState`)
+     * @return the value of the position for AI, the quicker win is the better
+     */
+    float GetHeuristic(std::pair<game::State, game::Cell> result, int depth) const noexcept;
 
 protected:
+    // the deadline is checked once per this number of nodes
+    static constexpr size_t CHECK_PERIOD { 1024 };
+    // value of the win: greater than any depth (20 for tic-tac-toe)
+    static constexpr int WIN_SCORE { static_cast<int>(State_t::SIZE) + 11 };
+
     // statistics:
     // number of opened nodes
     size_t m_expanded { 0u };
+    // of the current `Run`
+    Deadline m_deadline{};
 
 private:
 
-    float Apply(State_t, int depth, bool isMaximizingPlayer);
+    // @param lastMove the cell of the move made the state: only its lines are checked
+    float Apply(State_t, size_t lastMove, int depth, bool isMaximizingPlayer);
+
+    // the current search was interrupted by the deadline
+    bool m_stopped { false };
 
 };
 
-class AlphaBettaMinimax: public Minimax {
+template<class Game_t>
+class BasicAlphaBettaMinimax: public BasicMinimax<Game_t> {
 public:
+    using Minimax_t = BasicMinimax<Game_t>;
+    using typename Minimax_t::State_t;
+
     static constexpr float INF { 1000000.f };
+    // no time limit
+    static constexpr uint64_t UNLIMITED { 0 };
 
-    using Minimax::Minimax;
+    /**
+     * @param player identity (basicaly correspond to his turn in the game)
+     * @param timeLimit time limit in microseconds (`UNLIMITED` by default)
+     * @param threads number of threads searching the root moves (the calling thread is one of them),
+     * the others are started here and live as long as the solver
+     */
+    BasicAlphaBettaMinimax(uint8_t player
+        , uint64_t timeLimit = UNLIMITED
+        , size_t threads = 1
+    );
+
+    BasicAlphaBettaMinimax(const BasicAlphaBettaMinimax&) = delete;
+    BasicAlphaBettaMinimax& operator=(const BasicAlphaBettaMinimax&) = delete;
+
+    ~BasicAlphaBettaMinimax() override;
 
     /**
-     * Run minimax algorithm with alpha-beta pruning for the given board state
+     * Run minimax algorithm with alpha-beta pruning for the given board state.
+     * Iterative deepening: the search is repeated with increasing depth until the full depth
+     * or the time limit (deadline) is reached; the best move of the last completed depth is returned.
+     * Moves are ordered by the previous iteration (principal variation), 
+     * killer and history heuristics.
+     * Already evaluated positions (up to the board symmetry) are taken from the transposition table.
+     * With several threads the first root move is searched alone and the rest are shared
+     * between the threads (young brothers wait), the chosen move is the same as with one thread.
      * @param board is a current game state
+     * @param deadline is checked along with the time limit, the search stops at the earlier one;
+     * with either of them the first iteration is always completed to have a move
      * @return the best move. To extract row and col do the following:
-     * - row = return_value / 3; 
-     * - col = return_value % 3
+     * - row = return_value / State_t::COLS;
+     * - col = return_value % State_t::COLS
      */
-    size_t Run(State_t state) override;
+    size_t Run(State_t state, const Deadline& deadline) override;
+
+    using Minimax_t::Run;
+
+    void Print(std::ostream& os) const override;
 
 private:
-    float Apply(State_t
+    using Minimax_t::m_player;
+    using Minimax_t::m_elapsed;
+    using Minimax_t::m_expanded;
+    using Minimax_t::m_deadline;
+    using Minimax_t::CHECK_PERIOD;
+    using Minimax_t::GetHeuristic;
+    using Table_t = TranspositionTable<State_t>;
+
+    // the depth of full search: the root move and the replies filling the board
+    static constexpr int MAX_DEPTH { static_cast<int>(State_t::SIZE) };
+
+    // state of the thread searching root moves
+    struct Searcher {
+        // positions evaluated during the current search (keyed by canonical form)
+        Table_t m_table{};
+        // moves caused a cutoff at the given ply: 2 for each ply
+        uint8_t m_killers[MAX_DEPTH + 1][2] {};
+        // [isMaximizingPlayer][cell] - how good the move was in cutoffs
+        uint32_t m_history[2][State_t::SIZE] {};
+        // number of opened nodes
+        size_t m_expanded { 0u };
+    };
+
+    // root move with the value found by the last completed iteration
+    struct RootMove {
+        size_t  m_cell { 0 };
+        float   m_value { 0.f };
+    };
+
+    float Apply(Searcher& searcher
+        , State_t
+        , size_t lastMove
         , int depth
         , float alpha
         , float beta
         , bool isMaximizingPlayer
     );
+
+    /**
+     * Search root moves of the current iteration taking them one by one
+     * from the shared counter `m_next`; `m_alpha` is raised by the found values
+     */
+    void SearchRoot(Searcher& searcher, State_t board, RootMove* moves, size_t count);
+
+    // wait for the root moves of the iterations and search them until the solver is destroyed
+    void Loop(Searcher& searcher);
+
+    // @return true when the search must be stopped
+    bool IsTimeOver(const Searcher& searcher) noexcept;
+
+    const uint64_t m_timeLimit { UNLIMITED };
+    // the current iteration was interrupted by the time limit or the deadline
+    std::atomic<bool> m_aborted { false };
+    // depth of the current iteration
+    int m_iteration { 0 };
+    // depth of the last completed iteration
+    int m_completed { 0 };
+    // the first searcher belongs to the calling thread
+    std::vector<Searcher> m_searchers{};
+    // index of the next root move to search
+    std::atomic<size_t> m_next { 0 };
+    // the best value of the root moves of the current iteration
+    std::atomic<float> m_alpha { -INF };
+
+    // the helpers: a thread for each searcher but the first one
+    std::vector<std::thread> m_threads{};
+    std::mutex m_mutex;
+    std::condition_variable m_started;
+    std::condition_variable m_finished;
+    // number of the current round of the root moves, helpers wait for the change
+    uint64_t m_round { 0 };
+    // number of helpers still searching the current round
+    size_t m_running { 0 };
+    bool m_stopped { false };
+    // the root moves of the current round
+    State_t m_board{};
+    RootMove* m_moves { nullptr };
+    size_t m_count { 0 };
 };
 
+using Minimax = BasicMinimax<TicTacToe>;
+using AlphaBettaMinimax = BasicAlphaBettaMinimax<TicTacToe>;
+
 } // namespace solution
 
 #endif // MINIMAX_HPP_
\ No newline at end of file
@@ -0,0 +1,178 @@
+#include "Negamax.hpp"
+
+#include <cassert>
+#include <chrono>
+#include <algorithm>
+
+namespace solution {
+
+template<class Game_t>
+BasicNegamax<Game_t>::BasicNegamax(
+    uint8_t player
+    , Mode mode
+)
+    : Solver_t { player }
+    , m_mode { mode }
+    , m_cells { Game_t::Mark(player), Game_t::Mark(Game_t::GetNextPlayer(player)) }
+{
+    assert(m_player <= 1);
+}
+
+template<class Game_t>
+size_t BasicNegamax<Game_t>::Run(State_t board, const Deadline& deadline) {
+    const auto start = std::chrono::system_clock::now();
+    m_expanded = 0u;
+    m_deadline = deadline;
+    m_stopped = false;
+    m_table.Clear();
+
+    const auto depth = static_cast<int>(game::details::CountBits(board.freeCells()));
+    // Look through all possible moves in index order,
+    // the first of the equally good moves is chosen.
+    auto bestHeuristic { -INF };
+    // the first free cell when the deadline doesn't let to search any move
+    size_t bestMove { game::details::LowestBit(board.freeCells()) };
+    for(const auto i: game::Cells { board.freeCells() }) {
+        m_expanded++;
+        board.assign(i, m_cells[0]);
+        int heuristic { -INF };
+        if (m_mode == Mode::MTDF) {
+            heuristic = -this->Mtdf(board, i, depth - 1, bestHeuristic == -INF? 0 : -bestHeuristic, 1);
+        }
+        else if (bestHeuristic == -INF) {
+            heuristic = -this->Search(board, i, depth - 1, -INF, INF, 1);
+        }
+        else {
+            // only strictly better move is interesting: prove it by the null window
+            heuristic = -this->Search(board, i, depth - 1, -bestHeuristic - 1, -bestHeuristic, 1);
+            if (heuristic > bestHeuristic) {
+                heuristic = -this->Search(board, i, depth - 1, -INF, -bestHeuristic, 1);
+            }
+        }
+        board.clear(i);
+        if (m_stopped) {
+            break;
+        }
+        if (bestHeuristic < heuristic) {
+            bestHeuristic = heuristic;
+            bestMove = i;
+        }
+    }
+    const auto end = std::chrono::system_clock::now();
+    const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    m_elapsed = static_cast<uint64_t>(elapsed);
+    return bestMove;
+}
+
+template<class Game_t>
+int BasicNegamax<Game_t>::Mtdf(State_t state, size_t lastMove, int depth, int guess, size_t mover) {
+    auto value { guess };
+    auto lower { -INF };
+    auto upper { INF };
+    while (lower < upper && !m_stopped) {
+        const auto beta = std::max(value, lower + 1);
+        value = this->Search(state, lastMove, depth, beta - 1, beta, mover);
+        if (value < beta) {
+            upper = value;
+        }
+        else {
+            lower = value;
+        }
+    }
+    return value;
+}
+
+template<class Game_t>
+int BasicNegamax<Game_t>::Search(State_t state, size_t lastMove, int depth, int alpha, int beta, size_t mover) {
+    using Bound = typename TranspositionTable<State_t>::Bound;
+
+    if (m_expanded % CHECK_PERIOD == 0 && !m_stopped && m_deadline.IsExpired()) {
+        m_stopped = true;
+    }
+    if (m_stopped) {
+        return 0;
+    }
+    const auto [result, winner] = Game_t::GetState(state, lastMove);
+    if (result == game::State::WIN) {
+        return winner == m_cells[mover]? WIN_SCORE + depth : -WIN_SCORE - depth;
+    }
+    if (result == game::State::DRAW || !depth) {
+        return 0;
+    }
+
+    // all symmetric boards share the same entry
+    const auto [canonical, symmetry] = game::Canonical(state);
+    const auto initialAlpha = alpha;
+    const auto initialBeta = beta;
+    auto freeCells = state.freeCells();
+    size_t firstMove { State_t::SIZE };
+    if (auto entry = m_table.Find(canonical); entry && entry->m_depth == depth) {
+        const auto value = static_cast<int>(entry->m_value);
+        switch(entry->m_bound) {
+            case Bound::EXACT: return value;
+            case Bound::LOWER: alpha = std::max(alpha, value); break;
+            case Bound::UPPER: beta = std::min(beta, value); break;
+            default: break;
+        }
+        if (alpha >= beta) {
+            return value;
+        }
+        firstMove = game::TransformCell<State_t>(entry->m_move, game::InverseSymmetry(symmetry));
+        assert(game::details::HasBit(freeCells, firstMove) && "The stored move must be free");
+    }
+
+    auto heuristic { -INF };
+    size_t bestMove { 0 };
+    bool isFirst { true };
+    // `firstMove` (if any) goes first, the rest go in index order
+    while(freeCells) {
+        const auto i = firstMove != State_t::SIZE? firstMove : game::details::LowestBit(freeCells);
+        freeCells &= ~game::details::Bit<typename State_t::Mask_t>(i);
+        firstMove = State_t::SIZE;
+        m_expanded++;
+        state.assign(i, m_cells[mover]);
+        int value { 0 };
+        if (isFirst) {
+            value = -this->Search(state, i, depth - 1, -beta, -alpha, mover ^ 1U);
+            isFirst = false;
+        }
+        else {
+            value = -this->Search(state, i, depth - 1, -alpha - 1, -alpha, mover ^ 1U);
+            if (alpha < value && value < beta) {
+                value = -this->Search(state, i, depth - 1, -beta, -alpha, mover ^ 1U);
+            }
+        }
+        state.clear(i);
+        // the unfinished value must not get into the table
+        if (m_stopped) {
+            return 0;
+        }
+        if (heuristic < value) {
+            heuristic = value;
+            bestMove = i;
+        }
+        alpha = std::max(alpha, value);
+        if (alpha >= beta) {
+            break;
+        }
+    }
+
+    const auto bound = heuristic <= initialAlpha? Bound::UPPER
+        : heuristic >= initialBeta? Bound::LOWER
+        : Bound::EXACT;
+    m_table.Store(canonical, static_cast<float>(heuristic), bound, depth, game::TransformCell<State_t>(bestMove, symmetry));
+    return heuristic;
+}
+
+template<class Game_t>
+void BasicNegamax<Game_t>::Print(std::ostream& os) const {
+    os << "Look through: " << m_expanded << " nodes\n";
+    os << "Elapsed time: " << m_elapsed / 1'000.f << " ms\n";
+}
+
+template class BasicNegamax<TicTacToe>;
+template class BasicNegamax<BasicGame<game::Board4x4>>;
+template class BasicNegamax<BasicGame<game::Board7x7>>;
+template class BasicNegamax<BasicGame<game::Gomoku>>;
+
+} // namespace solution
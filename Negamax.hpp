@@ -0,0 +1,89 @@
+#ifndef NEGAMAX_HPP_
+#define NEGAMAX_HPP_
+
+#include "Solver.hpp"
+#include "TranspositionTable.hpp"
+
+namespace solution {
+
+/**
+ * Integer negamax with principal variation search (null window
+ * searches with re-search on fail high) or MTD(f).
+ * It chooses the same moves as `Minimax`.
+ */
+template<class Game_t>
+class BasicNegamax final : public BasicSolver<typename Game_t::State_t> {
+public:
+    using Solver_t = BasicSolver<typename Game_t::State_t>;
+    using typename Solver_t::State_t;
+
+    enum class Mode: uint8_t { PVS, MTDF };
+
+    /**
+     * @param player identity (basicaly correspond to his turn in the game)
+     * @param mode search algorithm used for each root move
+     */
+    BasicNegamax(uint8_t player, Mode mode = Mode::PVS);
+
+    /**
+     * Run negamax search for the given board state
+     * @param board is a current game state
+     * @param deadline when it expires the best of the completely searched root moves is returned
+     * @return the best move. To extract row and col do the following:
+     * - row = return_value / State_t::COLS;
+     * - col = return_value % State_t::COLS
+     */
+    size_t Run(State_t state, const Deadline& deadline) override;
+
+    using Solver_t::Run;
+
+    void Print(std::ostream& os) const override;
+
+    uint64_t Nodes() const noexcept override {
+        return m_expanded;
+    }
+
+    // number of nodes opened by the last `Run`
+    size_t Expanded() const noexcept {
+        return m_expanded;
+    }
+
+private:
+    using Solver_t::m_player;
+    using Solver_t::m_elapsed;
+
+    static constexpr int INF { 1'000 };
+    // value of the win/loss for the terminal state, the same as `Minimax::GetHeuristic`
+    static constexpr int WIN_SCORE { static_cast<int>(State_t::SIZE) + 11 };
+    // the deadline is checked once per this number of nodes
+    static constexpr size_t CHECK_PERIOD { 1024 };
+
+    /**
+     * Fail-soft principal variation search
+     * @param lastMove the cell of the move made the state: only its lines are checked
+     * @param mover index of the player who makes the move: 0 - AI, 1 - opponent
+     * @return value of the state for the mover
+     */
+    int Search(State_t state, size_t lastMove, int depth, int alpha, int beta, size_t mover);
+
+    // MTD(f): converge to the value by null window searches starting from `guess`
+    int Mtdf(State_t state, size_t lastMove, int depth, int guess, size_t mover);
+
+    const Mode  m_mode { Mode::PVS };
+    // of the current `Run`
+    Deadline m_deadline{};
+    // the current search was interrupted by the deadline, its values are meaningless
+    bool m_stopped { false };
+    // marks of the players: [0] - AI, [1] - opponent
+    const game::Cell m_cells[2] { game::Cell::FREE, game::Cell::FREE };
+    TranspositionTable<State_t> m_table{};
+    // statistics:
+    // number of opened nodes
+    size_t m_expanded { 0u };
+};
+
+using Negamax = BasicNegamax<TicTacToe>;
+
+} // namespace solution
+
+#endif // NEGAMAX_HPP_
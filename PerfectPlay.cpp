@@ -0,0 +1,183 @@
+#include "PerfectPlay.hpp"
+#include "Minimax.hpp"
+
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <vector>
+
+namespace {
+
+using game::Board;
+
+// number of all boards: each cell is either free, either 'x', either 'o'
+constexpr size_t POSITIONS { 19'683 };
+
+// value of the win/loss for the terminal state, the same as `Minimax::GetHeuristic`
+constexpr int WIN_SCORE { 20 };
+
+// 3^i for the i-th cell
+constexpr size_t POW3[Board::SIZE] = { 1, 3, 9, 27, 81, 243, 729, 2'187, 6'561 };
+
+// maps 9-bit mask of one player to the ternary index where each set bit contributes 3^i
+constexpr std::array<uint16_t, game::details::PLAYER_MASK + 1U> MakeTernaryTable() noexcept {
+    std::array<uint16_t, game::details::PLAYER_MASK + 1U> table {};
+    for(size_t mask = 0; mask <= game::details::PLAYER_MASK; mask++) {
+        for(size_t i = 0; i < Board::SIZE; i++) {
+            if(mask & (1U << i)) {
+                table[mask] += static_cast<uint16_t>(POW3[i]);
+            }
+        }
+    }
+    return table;
+}
+
+constexpr auto TERNARY { MakeTernaryTable() };
+
+// ternary index of the board: 0 - free, 1 - 'x', 2 - 'o'
+constexpr size_t ToIndex(Board board) noexcept {
+    const auto desk = board.unwrap();
+    return TERNARY[desk & game::details::PLAYER_MASK]
+        + 2U * TERNARY[(desk >> Board::SIZE) & game::details::PLAYER_MASK];
+}
+
+struct Entry {
+    // value for the player who makes a move, see `PerfectPlay::Evaluate`
+    int8_t  value { 0 };
+    // the best move for the player who makes a move
+    uint8_t move { 0 };
+};
+
+// [index][0] - 'x' makes a move, [index][1] - 'o' makes a move
+using Table_t = std::array<std::array<Entry, 2>, POSITIONS>;
+
+/**
+ * Retrograde evaluation: any move only increases the ternary index,
+ * so walking indices in the descending order guarantees that all children
+ * are evaluated before their parent.
+ * The depth `Minimax` uses is replaced by the number of free cells: it differs only
+ * by a constant within a single search, so it doesn't change which move is the best.
+ */
+constexpr Table_t MakeTable() noexcept {
+    Table_t table {};
+    for(size_t index = POSITIONS; index-- > 0;) {
+        size_t desk { 0 };
+        size_t freeCells { 0 };
+        size_t firstFree { Board::SIZE };
+        for(size_t i = 0, rest = index; i < Board::SIZE; i++, rest /= 3) {
+            switch(rest % 3) {
+                case 0: {
+                    freeCells++;
+                    firstFree = firstFree == Board::SIZE? i : firstFree;
+                } break;
+                case 1: desk |= 1U << i; break;
+                case 2: desk |= 1U << (i + Board::SIZE); break;
+                default: break;
+            }
+        }
+        const auto state = game::GetGameState(Board { desk });
+        for(size_t mover = 0; mover < 2; mover++) {
+            auto& entry = table[index][mover];
+            if(state.first != Board::State::ONGOING) {
+                // `Minimax` chooses the first free cell when all moves are equal
+                entry.move = static_cast<uint8_t>(firstFree == Board::SIZE? 0 : firstFree);
+                if(state.first == Board::State::WIN) {
+                    const auto score = static_cast<int>(WIN_SCORE + freeCells);
+                    entry.value = static_cast<int8_t>(static_cast<size_t>(state.second) == mover? score : -score);
+                }
+                continue;
+            }
+            int best { -WIN_SCORE * 2 };
+            for(size_t i = 0; i < Board::SIZE; i++) {
+                if((index / POW3[i]) % 3 == 0) {
+                    const auto child = index + (mover + 1U) * POW3[i];
+                    const auto value = -table[child][mover ^ 1U].value;
+                    if(best < value) {
+                        best = value;
+                        entry.move = static_cast<uint8_t>(i);
+                    }
+                }
+            }
+            entry.value = static_cast<int8_t>(best);
+        }
+    }
+    return table;
+}
+
+constexpr Table_t TABLE { MakeTable() };
+
+// perfect play from the empty board ends with a draw
+static_assert(TABLE[0][0].value == 0 && TABLE[0][1].value == 0);
+
+} // namespace
+
+namespace solution {
+
+PerfectPlay::PerfectPlay(uint8_t player)
+    : Solver { player }
+{
+    assert(m_player <= 1);
+}
+
+size_t PerfectPlay::Run(State_t board, const Deadline&) {
+    const auto start = std::chrono::system_clock::now();
+    const auto mover = static_cast<size_t>(TicTacToe::Mark(m_player));
+    assert(mover < 2 && "Player must be mapped to 'x' or 'o'");
+    const size_t bestMove { TABLE[ToIndex(board)][mover].move };
+    const auto end = std::chrono::system_clock::now();
+    const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    m_elapsed = static_cast<uint64_t>(elapsed);
+    return bestMove;
+}
+
+int PerfectPlay::Evaluate(State_t board) const noexcept {
+    const auto mover = static_cast<size_t>(TicTacToe::Mark(m_player));
+    assert(mover < 2 && "Player must be mapped to 'x' or 'o'");
+    return TABLE[ToIndex(board)][mover].value;
+}
+
+void PerfectPlay::Print(std::ostream& os) const {
+    os << "Look through: 1 node\n";
+    os << "Elapsed time: " << m_elapsed / 1'000.f << " ms\n";
+}
+
+int MoveValue(game::Board board, uint8_t player, size_t move) noexcept {
+    const auto next = board.assigned(move, TicTacToe::Mark(player));
+    if(const auto state = game::GetGameState(next).first; state != Board::State::ONGOING) {
+        return state == Board::State::WIN? 1 : 0;
+    }
+    const auto opponent = TABLE[ToIndex(next)][static_cast<size_t>(TicTacToe::Mark(player ^ 1U))].value;
+    return (opponent < 0) - (opponent > 0);
+}
+
+} // namespace solution
+
+void TestPerfectPlay() {
+    using game::Board;
+    std::cerr << "Test the perfect play table...\n";
+    solution::PerfectPlay perfect[2] = { solution::PerfectPlay { 0 }, solution::PerfectPlay { 1 } };
+    solution::Minimax minimax[2] = { solution::Minimax { 0 }, solution::Minimax { 1 } };
+
+    // walk through all positions reachable from the empty board ('x' moves first)
+    std::vector<bool> visited(POSITIONS, false);
+    std::vector<std::pair<Board, uint8_t>> positions { { Board{}, 0 } };
+    size_t checked { 0 };
+    while(!positions.empty()) {
+        const auto [board, player] = positions.back();
+        positions.pop_back();
+        if(visited[ToIndex(board)] || game::GetGameState(board).first != Board::State::ONGOING) {
+            continue;
+        }
+        visited[ToIndex(board)] = true;
+        checked++;
+        assert(perfect[player].Run(board) == minimax[player].Run(board)
+            && "Perfect play table disagrees with minimax");
+
+        const uint8_t next = player ^ 1U;
+        for(const auto i: game::Cells { board.freeCells() }) {
+            positions.emplace_back(board.assigned(i, solution::TicTacToe::Mark(player)), next);
+        }
+    }
+    assert(checked == 4'520 && "Unexpected number of non-terminal reachable positions");
+    std::cerr << "Complete test.\n";
+}
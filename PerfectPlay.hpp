@@ -0,0 +1,58 @@
+#ifndef PERFECT_PLAY_HPP_
+#define PERFECT_PLAY_HPP_
+
+#include "Solver.hpp"
+
+namespace solution {
+
+/**
+ * Perfect player which doesn't search at all: the best move and the value
+ * of every board are evaluated at compile time (retrograde analysis over
+ * all 3^9 boards) and embedded into the binary.
+ * It chooses exactly the same moves as `Minimax`.
+ */
+class PerfectPlay final : public Solver {
+public:
+
+    // @param player identity (basicaly correspond to his turn in the game), mapped to the mark by `TicTacToe`
+    explicit PerfectPlay(uint8_t player);
+
+    /**
+     * Look up the best move for the given board state
+     * @param board is a current game state
+     * @param deadline is ignored: the look up takes no time
+     * @return the best move. To extract row and col do the following:
+     * - row = return_value / 3;
+     * - col = return_value % 3
+     */
+    size_t Run(State_t state, const Deadline& deadline) override;
+
+    using Solver::Run;
+
+    void Print(std::ostream& os) const override;
+
+    uint64_t Nodes() const noexcept override {
+        return 1;
+    }
+
+    /**
+     * @return the value of the board for the player who makes the next move:
+     * positive - win, negative - loss, zero - draw.
+     * The faster win (or the slower loss) the greater absolute value.
+     */
+    int Evaluate(State_t state) const noexcept;
+};
+
+/**
+ * Perfect play oracle of the other engines' decisions
+ * @param player makes the move, mapped to the mark by `TicTacToe`
+ * @return the result of the move for the player who makes it: 1 - win, 0 - draw, -1 - loss.
+ * The move is optimal when it keeps the best result however long the game is
+ */
+int MoveValue(game::Board board, uint8_t player, size_t move) noexcept;
+
+} // namespace solution
+
+void TestPerfectPlay();
+
+#endif // PERFECT_PLAY_HPP_
@@ -0,0 +1,339 @@
+#include "Playout.hpp"
+#include "Random.hpp"
+
+#include <array>
+#include <cassert>
+#include <type_traits>
+#include <algorithm>
+#include <numeric>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    #define PLAYOUT_AVX2 1
+    #include <immintrin.h>
+#endif
+
+namespace {
+
+using game::Board;
+using solution::Playout;
+
+// maximum number of free cells, the table row is padded to 16
+constexpr size_t SELECT_ROW { 16 };
+
+// [mask * SELECT_ROW + r] - index of the r-th set bit of the 9-bit `mask`.
+// Padded by 3 bytes because AVX2 gathers 4 bytes at once.
+using SelectTable_t = std::array<uint8_t, (game::details::PLAYER_MASK + 1U) * SELECT_ROW + 3U>;
+
+constexpr SelectTable_t MakeSelectTable() noexcept {
+    SelectTable_t table {};
+    for(size_t mask = 0; mask <= game::details::PLAYER_MASK; mask++) {
+        size_t r { 0 };
+        for(size_t i = 0; i < Board::SIZE; i++) {
+            if(mask & (1U << i)) {
+                table[mask * SELECT_ROW + r++] = static_cast<uint8_t>(i);
+            }
+        }
+    }
+    return table;
+}
+
+alignas(64) constexpr SelectTable_t SELECT { MakeSelectTable() };
+
+// uniform value from [0, bound) using 16 high bits of the random value
+constexpr uint32_t Bounded(uint32_t random, uint32_t bound) noexcept {
+    return ((random >> 16) * bound) >> 16;
+}
+
+// `games` games ended with the board (x, o), `winner`: 0 - 'x', 1 - 'o', 2 - draw
+template<class Amaf_t, class Mask>
+void Record(Amaf_t& amaf, Mask x, Mask o, size_t winner, uint32_t games = 1u) noexcept {
+    const Mask masks[2] = { x, o };
+    for(size_t player = 0; player < 2; player++) {
+        const auto won = winner == player? games : 0u;
+        const auto lost = winner == (player ^ 1U)? games : 0u;
+        for(const auto cell: game::Cells { masks[player] }) {
+            amaf.m_games[player][cell] += games;
+            amaf.m_wins[player][cell] += won;
+            amaf.m_losses[player][cell] += lost;
+        }
+    }
+}
+
+/**
+ * Reference kernel: lanes go in lockstep exactly like in the AVX2 kernel,
+ * so both produce the same results for the same generator state.
+ */
+Playout::Result RunScalar(uint32_t x, uint32_t o, size_t mover, size_t count, uint32_t* lanes, Playout::Amaf* amaf) noexcept {
+    Playout::Result result;
+    const auto freeCells = static_cast<uint32_t>(game::details::CountBits(~(x | o) & game::details::PLAYER_MASK));
+    for(size_t first = 0; first < count; first += Playout::LANES) {
+        const auto active = std::min(Playout::LANES, count - first);
+        uint32_t masks[Playout::LANES][2];
+        bool finished[Playout::LANES];
+        // 2 - draw
+        size_t winners[Playout::LANES];
+        for(size_t lane = 0; lane < Playout::LANES; lane++) {
+            masks[lane][0] = x;
+            masks[lane][1] = o;
+            finished[lane] = lane >= active;
+            winners[lane] = 2;
+        }
+        size_t ongoing = active;
+        auto player = mover;
+        for(auto left = freeCells; left > 0 && ongoing > 0; left--, player ^= 1U) {
+            for(size_t lane = 0; lane < Playout::LANES; lane++) {
+                const auto random = solution::Xorshift32::Next(lanes[lane]);
+                if(finished[lane]) {
+                    continue;
+                }
+                const auto freeMask = ~(masks[lane][0] | masks[lane][1]) & game::details::PLAYER_MASK;
+                const auto cell = SELECT[freeMask * SELECT_ROW + Bounded(random, left)];
+                masks[lane][player] |= 1U << cell;
+                if(game::details::WIN_TABLE[masks[lane][player]]) {
+                    result.m_wins[player]++;
+                    finished[lane] = true;
+                    winners[lane] = player;
+                    ongoing--;
+                }
+            }
+        }
+        result.m_draws += static_cast<uint32_t>(ongoing);
+        for(size_t lane = 0; amaf && lane < active; lane++) {
+            Record(*amaf, masks[lane][0], masks[lane][1], winners[lane]);
+        }
+    }
+    return result;
+}
+
+#ifdef PLAYOUT_AVX2
+
+__attribute__((target("avx2")))
+Playout::Result RunAvx2(uint32_t x, uint32_t o, size_t mover, size_t count, uint32_t* lanes, Playout::Amaf* amaf) noexcept {
+    Playout::Result result;
+    const auto freeCells = static_cast<uint32_t>(game::details::CountBits(~(x | o) & game::details::PLAYER_MASK));
+    const auto one = _mm256_set1_epi32(1);
+    const auto byte = _mm256_set1_epi32(0xFF);
+    const auto full = _mm256_set1_epi32(static_cast<int>(game::details::PLAYER_MASK));
+    const auto laneIndex = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256i lines[std::size(game::details::LINES)];
+    for(size_t i = 0; i < std::size(game::details::LINES); i++) {
+        lines[i] = _mm256_set1_epi32(game::details::LINES[i]);
+    }
+    auto state = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lanes));
+    for(size_t first = 0; first < count; first += Playout::LANES) {
+        const auto active = static_cast<int>(std::min(Playout::LANES, count - first));
+        __m256i masks[2] = { _mm256_set1_epi32(static_cast<int>(x)), _mm256_set1_epi32(static_cast<int>(o)) };
+        // all bits are set for lanes which are still playing
+        auto ongoing = _mm256_cmpgt_epi32(_mm256_set1_epi32(active), laneIndex);
+        // [player] - lane mask of the games won by the player
+        uint32_t winners[2] = { 0u, 0u };
+        auto player = mover;
+        for(auto left = freeCells; left > 0 && !_mm256_testz_si256(ongoing, ongoing); left--, player ^= 1U) {
+            state = _mm256_xor_si256(state, _mm256_slli_epi32(state, 13));
+            state = _mm256_xor_si256(state, _mm256_srli_epi32(state, 17));
+            state = _mm256_xor_si256(state, _mm256_slli_epi32(state, 5));
+            const auto r = _mm256_srli_epi32(
+                _mm256_mullo_epi32(_mm256_srli_epi32(state, 16), _mm256_set1_epi32(static_cast<int>(left))), 16);
+            const auto freeMask = _mm256_andnot_si256(_mm256_or_si256(masks[0], masks[1]), full);
+            const auto index = _mm256_add_epi32(_mm256_slli_epi32(freeMask, 4), r);
+            const auto cell = _mm256_and_si256(
+                _mm256_i32gather_epi32(reinterpret_cast<const int*>(SELECT.data()), index, 1), byte);
+            const auto bit = _mm256_and_si256(_mm256_sllv_epi32(one, cell), ongoing);
+            masks[player] = _mm256_or_si256(masks[player], bit);
+            auto won = _mm256_setzero_si256();
+            for(const auto& line: lines) {
+                won = _mm256_or_si256(won, _mm256_cmpeq_epi32(_mm256_and_si256(masks[player], line), line));
+            }
+            won = _mm256_and_si256(won, ongoing);
+            const auto wonLanes = static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(won)));
+            result.m_wins[player] += static_cast<uint32_t>(game::details::CountBits(wonLanes));
+            winners[player] |= wonLanes;
+            ongoing = _mm256_andnot_si256(won, ongoing);
+        }
+        result.m_draws += static_cast<uint32_t>(game::details::CountBits(static_cast<uint32_t>(
+            _mm256_movemask_ps(_mm256_castsi256_ps(ongoing)))));
+        if(amaf) {
+            uint32_t finals[2][Playout::LANES];
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(finals[0]), masks[0]);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(finals[1]), masks[1]);
+            for(int lane = 0; lane < active; lane++) {
+                const size_t winner = (winners[0] >> lane) & 1U? 0 : (winners[1] >> lane) & 1U? 1 : 2;
+                Record(*amaf, finals[0][lane], finals[1][lane], winner);
+            }
+        }
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), state);
+    return result;
+}
+
+#endif // PLAYOUT_AVX2
+
+/**
+ * Kernel of the boards other than tic-tac-toe: the games are played one after another,
+ * the move is taken from the list of free cells and replaced by the last one of the list
+ */
+template<class Playout_t, class Board_t>
+typename Playout_t::Result RunGeneric(Board_t board, size_t mover, size_t count, uint32_t* lanes
+    , typename Playout_t::Amaf* amaf
+) noexcept {
+    typename Playout_t::Result result;
+    const game::Cell marks[2] = { game::Cell::X, game::Cell::O };
+    uint8_t freeCells[Board_t::SIZE];
+    uint32_t size { 0 };
+    for(const auto cell: game::Cells { board.freeCells() }) {
+        freeCells[size++] = static_cast<uint8_t>(cell);
+    }
+    for(size_t i = 0; i < count; i++) {
+        auto& random = lanes[i % Playout_t::LANES];
+        uint8_t moves[Board_t::SIZE];
+        std::copy(freeCells, freeCells + size, moves);
+        auto final = board;
+        // 2 - draw
+        size_t winner { 2 };
+        auto player = mover;
+        for(auto left = size; left > 0; left--, player ^= 1U) {
+            const auto r = Bounded(solution::Xorshift32::Next(random), left);
+            const auto cell = moves[r];
+            moves[r] = moves[left - 1];
+            final.assign(cell, marks[player]);
+            if(game::GetGameState(final, cell).first == game::State::WIN) {
+                winner = player;
+                break;
+            }
+        }
+        if(winner < 2) {
+            result.m_wins[winner]++;
+        }
+        else {
+            result.m_draws++;
+        }
+        if(amaf) {
+            Record(*amaf, final.marks(game::Cell::X), final.marks(game::Cell::O), winner);
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+namespace solution {
+
+template<class Board_t>
+BasicPlayout<Board_t>::BasicPlayout(uint32_t seed) noexcept {
+    // splitmix32 gives distinct non-zero states for xorshift
+    for(auto& lane: m_lanes) {
+        seed += 0x9E3779B9u;
+        auto z = seed;
+        z = (z ^ (z >> 16)) * 0x85EBCA6Bu;
+        z = (z ^ (z >> 13)) * 0xC2B2AE35u;
+        z ^= z >> 16;
+        lane = z? z : 1u;
+    }
+#ifdef PLAYOUT_AVX2
+    m_simd = std::is_same_v<Board_t, game::Board> && __builtin_cpu_supports("avx2");
+#endif
+}
+
+template<class Board_t>
+typename BasicPlayout<Board_t>::Result BasicPlayout<Board_t>::Run(
+    Board_t board
+    , game::Cell mover
+    , size_t count
+    , Amaf* amaf
+) noexcept {
+    assert(mover != game::Cell::FREE && "The mover must be either 'x' either 'o'");
+    Result result;
+    if(amaf) {
+        *amaf = Amaf{};
+    }
+    const auto x = board.marks(game::Cell::X);
+    const auto o = board.marks(game::Cell::O);
+    const auto [state, winner] = game::GetGameState(board);
+    switch(state) {
+        case game::State::WIN: {
+            result.m_wins[static_cast<size_t>(winner)] = static_cast<uint32_t>(count);
+            if(amaf) {
+                Record(*amaf, x, o, static_cast<size_t>(winner), static_cast<uint32_t>(count));
+            }
+        } break;
+        case game::State::DRAW: {
+            result.m_draws = static_cast<uint32_t>(count);
+            if(amaf) {
+                Record(*amaf, x, o, 2, static_cast<uint32_t>(count));
+            }
+        } break;
+        case game::State::ONGOING: {
+            const auto player = static_cast<size_t>(mover);
+            if constexpr (std::is_same_v<Board_t, game::Board>) {
+#ifdef PLAYOUT_AVX2
+                if(m_simd) {
+                    result = RunAvx2(static_cast<uint32_t>(x), static_cast<uint32_t>(o), player, count, m_lanes, amaf);
+                    break;
+                }
+#endif
+                result = RunScalar(static_cast<uint32_t>(x), static_cast<uint32_t>(o), player, count, m_lanes, amaf);
+            }
+            else {
+                result = RunGeneric<BasicPlayout>(board, player, count, m_lanes, amaf);
+            }
+        } break;
+        default: break;
+    }
+    return result;
+}
+
+template class BasicPlayout<game::Board>;
+template class BasicPlayout<game::Board4x4>;
+template class BasicPlayout<game::Board7x7>;
+template class BasicPlayout<game::Gomoku>;
+
+} // namespace solution
+
+void TestPlayout() {
+    std::cerr << "Test the playout...\n";
+    solution::Playout simd { 42u };
+    solution::Playout scalar { 42u };
+    scalar.DisableSimd();
+
+    Board board;
+    const size_t games { 1000 };
+    for(size_t i = 0; i < 3; i++) {
+        solution::Playout::Amaf lhsAmaf, rhsAmaf;
+        [[maybe_unused]] const auto lhs = simd.Run(board, Board::Cell::X, games + i, &lhsAmaf);
+        [[maybe_unused]] const auto rhs = scalar.Run(board, Board::Cell::X, games + i, &rhsAmaf);
+        assert(lhs.m_wins[0] == rhs.m_wins[0] && lhs.m_wins[1] == rhs.m_wins[1] && lhs.m_draws == rhs.m_draws
+            && "Kernels must produce the same games");
+        assert(lhs.m_wins[0] + lhs.m_wins[1] + lhs.m_draws == games + i && "Lost some games");
+        assert(std::equal(&lhsAmaf.m_games[0][0], &lhsAmaf.m_games[0][0] + 2 * Board::SIZE, &rhsAmaf.m_games[0][0])
+            && std::equal(&lhsAmaf.m_wins[0][0], &lhsAmaf.m_wins[0][0] + 2 * Board::SIZE, &rhsAmaf.m_wins[0][0])
+            && "Kernels must collect the same statistics");
+        // 'x' moves first so it has at least as many marks as 'o' in every game
+        assert(std::accumulate(&lhsAmaf.m_games[0][0], &lhsAmaf.m_games[0][0] + Board::SIZE, 0u)
+            >= std::accumulate(&lhsAmaf.m_games[1][0], &lhsAmaf.m_games[1][0] + Board::SIZE, 0u)
+            && "Wrong number of marks");
+        board.assign(i, i, i % 2? Board::Cell::O : Board::Cell::X);
+    }
+
+    // x . .
+    // o x .
+    // o . .  'x' to move: some games are won by 'x' immediately, 'o' can't win before
+    board = Board {};
+    board.assign(0, 0, Board::Cell::X);
+    board.assign(1, 1, Board::Cell::X);
+    board.assign(1, 0, Board::Cell::O);
+    board.assign(2, 0, Board::Cell::O);
+    [[maybe_unused]] const auto result = scalar.Run(board, Board::Cell::X, games);
+    assert(result.m_wins[0] > games / 5 && "'x' must win more often than in 1/5 games");
+
+    // the generic kernel: all games are finished, each game of 4x4 board ends with at least 4 'x' marks
+    solution::BasicPlayout<game::Board4x4> generic { 42u };
+    solution::BasicPlayout<game::Board4x4>::Amaf amaf;
+    [[maybe_unused]] const auto large = generic.Run(game::Board4x4{}, Board::Cell::X, games, &amaf);
+    assert(!generic.IsSimd() && "Only tic-tac-toe has SIMD kernel");
+    assert(large.m_wins[0] + large.m_wins[1] + large.m_draws == games && "Lost some games");
+    assert(std::accumulate(&amaf.m_games[0][0], &amaf.m_games[0][0] + game::Board4x4::SIZE, 0u) >= 4 * games
+        && "Wrong number of marks");
+    assert(std::accumulate(&amaf.m_wins[0][0], &amaf.m_wins[0][0] + game::Board4x4::SIZE, 0u) >= 4 * large.m_wins[0]
+        && "Wrong statistics of the wins");
+    std::cerr << "Complete test.\n";
+}
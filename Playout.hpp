@@ -0,0 +1,70 @@
+#ifndef PLAYOUT_HPP_
+#define PLAYOUT_HPP_
+
+#include "Board.hpp"
+
+#include <cstdint>
+#include <cstddef>
+
+namespace solution {
+
+/**
+ * Plays random games from the given board in batches:
+ * `LANES` games are advanced at once in AVX2 lanes (or one after another
+ * when AVX2 isn't available). Each lane has its own xorshift generator
+ * and doesn't allocate memory.
+ * The lanes are used only on tic-tac-toe board, on the other boards
+ * the games are played one after another by the scalar kernel.
+ */
+template<class Board_t>
+class BasicPlayout final {
+public:
+    static constexpr size_t LANES { 8 };
+
+    struct Result {
+        // number of games won by 'x' and 'o' respectively
+        uint32_t m_wins[2] { 0u, 0u };
+        uint32_t m_draws { 0u };
+    };
+
+    // all-moves-as-first statistics collected from the final boards of the games
+    struct Amaf {
+        // [player][cell] - number of games ended with the player's mark in the cell ('x' - 0, 'o' - 1)
+        uint32_t m_games[2][Board_t::SIZE] {};
+        // [player][cell] - how many of these games the player won and lost
+        uint32_t m_wins[2][Board_t::SIZE] {};
+        uint32_t m_losses[2][Board_t::SIZE] {};
+    };
+
+    explicit BasicPlayout(uint32_t seed = 1u) noexcept;
+
+    /**
+     * @param board  position to start from
+     * @param mover  mark of the player who makes the next move: 'x' or 'o'
+     * @param count  number of games to play
+     * @param amaf   if not null, receives the statistics of the games' final boards
+     */
+    Result Run(Board_t board, game::Cell mover, size_t count, Amaf* amaf = nullptr) noexcept;
+
+    // use the scalar kernel even if AVX2 is supported
+    void DisableSimd() noexcept {
+        m_simd = false;
+    }
+
+    bool IsSimd() const noexcept {
+        return m_simd;
+    }
+
+private:
+    // state of xorshift generator for each lane
+    uint32_t m_lanes[LANES] {};
+    bool m_simd { false };
+};
+
+using Playout = BasicPlayout<game::Board>;
+
+} // namespace solution
+
+void TestPlayout();
+
+#endif // PLAYOUT_HPP_
@@ -0,0 +1,52 @@
+#ifndef RANDOM_HPP_
+#define RANDOM_HPP_
+
+#include <cstdint>
+#include <cstddef>
+
+namespace solution {
+
+/**
+ * xorshift32 generator: 4 bytes of state and a few cycles per number,
+ * good enough for the tree and playout policies.
+ */
+class Xorshift32 final {
+public:
+    constexpr explicit Xorshift32(uint32_t seed = 1u) noexcept
+        : m_state { seed? seed : 1u }
+    {}
+
+    // advance the generator's state in place, the state must not be zero
+    static constexpr uint32_t Next(uint32_t& state) noexcept {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    constexpr uint32_t operator()() noexcept {
+        return Next(m_state);
+    }
+
+    // uniform value from [0, bound) by multiplication instead of modulo
+    constexpr uint32_t operator()(uint32_t bound) noexcept {
+        return static_cast<uint32_t>((static_cast<uint64_t>(Next(m_state)) * bound) >> 32u);
+    }
+
+private:
+    uint32_t m_state { 1u };
+};
+
+// @return the uniformly chosen cell of the not empty `cells` (see `game::Cells`)
+template<class Cells_t>
+constexpr size_t RandomCell(const Cells_t& cells, Xorshift32& random) noexcept {
+    auto cell = cells.begin();
+    for(auto skip = random(static_cast<uint32_t>(cells.size())); skip > 0; skip--) {
+        ++cell;
+    }
+    return *cell;
+}
+
+} // namespace solution
+
+#endif // RANDOM_HPP_
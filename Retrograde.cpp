@@ -0,0 +1,129 @@
+#include "Tablebase.hpp"
+#include "Minimax.hpp"
+#include "Random.hpp"
+
+#include <chrono>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <string>
+
+namespace {
+
+/**
+ * Random positions are played to the end by the tablebase against alpha-beta,
+ * with each of them on the side to move: the result must be the value of the position
+ * @param samples number of the positions
+ * @return number of the games disagreeing with the table
+ */
+template<class Board_t>
+size_t Verify(std::shared_ptr<const solution::BasicTablebase<Board_t>> table, size_t samples) {
+    using Game = solution::BasicGame<Board_t>;
+    using Table = solution::BasicTablebase<Board_t>;
+    solution::BasicTablebasePlay<Game> tablebase[2] = { { 0, table }, { 1, table } };
+    solution::BasicAlphaBettaMinimax<Game> alphabeta[2] = { solution::BasicAlphaBettaMinimax<Game> { 0 }
+        , solution::BasicAlphaBettaMinimax<Game> { 1 } };
+
+    size_t failures { 0 };
+    solution::Xorshift32 random { 11u };
+    for(size_t sample = 0; sample < samples;) {
+        // alpha-beta takes too long from the earlier positions of the larger boards
+        Board_t board;
+        uint8_t player { 0 };
+        for(size_t marks = 0; marks < Board_t::SIZE / 2 - 1 && !Game::IsTerminal(board); marks++, player ^= 1) {
+            board.assign(solution::RandomCell(game::Cells { board.freeCells() }, random), Game::Mark(player));
+        }
+        if(Game::IsTerminal(board)) {
+            continue;
+        }
+        sample++;
+        const auto value = table->Probe(board).m_value;
+        for(const auto tablebaseMoves: { true, false }) {
+            auto position = board;
+            auto mover = player;
+            for(; !Game::IsTerminal(position); mover ^= 1) {
+                const auto byTablebase = (mover == player) == tablebaseMoves;
+                const auto move = byTablebase? tablebase[mover].Run(position) : alphabeta[mover].Run(position);
+                if(position.at(move) != game::Cell::FREE) {
+                    break;
+                }
+                position.assign(move, Game::Mark(mover));
+            }
+            const auto [state, winner] = Game::GetState(position);
+            const auto result = state != game::State::WIN? Table::Value::DRAW
+                : winner == Game::Mark(player)? Table::Value::WIN
+                : Table::Value::LOSS;
+            // the game isn't finished after an illegal move
+            if(state == game::State::ONGOING || result != value) {
+                std::cerr << "The table disagrees with alpha-beta on\n" << board;
+                failures++;
+            }
+        }
+    }
+    return failures;
+}
+
+// @return the exit code
+template<class Board_t>
+int Solve(const std::string& path, size_t samples) {
+    try {
+        const auto start = std::chrono::steady_clock::now();
+        solution::BuildTablebase<Board_t>(path);
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        // check the file the way the solver opens it
+        const auto table = std::make_shared<const solution::BasicTablebase<Board_t>>(path);
+        std::cout << "Solved " << table->Size() << " positions in "
+            << std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count() / 1'000.f << " ms\n";
+        if(samples > 0) {
+            const auto failures = Verify(table, samples);
+            std::cout << "Verified " << samples << " positions against alpha-beta: " << failures << " failures\n";
+            return failures? 1 : 0;
+        }
+    }
+    catch(const std::exception& error) {
+        std::cerr << error.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+} // namespace
+
+/**
+ * Solves all positions of the game by retrograde analysis
+ * and writes the table mapped by `TablebasePlay`.
+ * Usage: tic-tac-toe-retrograde [--board 3x3|4x4] [--verify N] <file>
+ * 3x3 (tic-tac-toe) by default, 4x4 is played with 4 in a row;
+ * --verify plays N random positions to the end by the table against alpha-beta
+ */
+int main(int argc, char** argv) {
+    std::string board { "3x3" };
+    size_t samples { 0 };
+    std::string path;
+    bool valid { true };
+    for(int i = 1; i < argc && valid; i++) {
+        const std::string arg { argv[i] };
+        if(arg == "--board" && i + 1 < argc) {
+            board = argv[++i];
+        }
+        else if(arg == "--verify" && i + 1 < argc) {
+            try {
+                samples = std::stoul(argv[++i]);
+            }
+            catch(const std::exception&) {
+                valid = false;
+            }
+        }
+        else if(path.empty() && arg.rfind("--", 0) != 0) {
+            path = arg;
+        }
+        else {
+            valid = false;
+        }
+    }
+    if(!valid || path.empty() || (board != "3x3" && board != "4x4")) {
+        std::cerr << "Usage: " << argv[0] << " [--board 3x3|4x4] [--verify N] <file>\n";
+        return 1;
+    }
+    return board == "3x3"? Solve<game::Board>(path, samples) : Solve<game::Board4x4>(path, samples);
+}
@@ -0,0 +1,455 @@
+#include "Server.hpp"
+#include "Minimax.hpp"
+#include "Negamax.hpp"
+#include "MCTS.hpp"
+#include "PerfectPlay.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+
+#ifndef _WIN32
+    #include <sys/socket.h>
+    #include <sys/un.h>
+    #include <unistd.h>
+#endif
+
+namespace {
+
+using game::Board;
+
+// indexed by `Server::Kind`
+constexpr const char* KIND_NAMES[] = { "minimax", "alphabeta", "negamax", "mcts", "perfect" };
+
+// commands executed by the session's worker
+constexpr const char* SESSION_COMMANDS[] = { "new", "move", "go", "end" };
+
+Board::Cell Mark(uint8_t player) noexcept {
+    return player == 0? Board::Cell::X : Board::Cell::O;
+}
+
+// 'x' moves first: the player to move is defined by the number of marks
+uint8_t Mover(Board board) noexcept {
+    return static_cast<uint8_t>(game::details::CountBits(static_cast<uint32_t>(board.unwrap())) % 2);
+}
+
+const char* StateName(Board board) noexcept {
+    const auto [state, winner] = game::GetGameState(board);
+    return state == Board::State::ONGOING? "ongoing"
+        : state == Board::State::DRAW? "draw"
+        : winner == Board::Cell::X? "x" : "o";
+}
+
+// only decimal digits are accepted
+bool ParseNumber(const std::string& text, uint64_t& value) noexcept {
+    if(text.empty() || text.size() > 18 || !std::all_of(text.begin(), text.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+        return false;
+    }
+    value = std::strtoull(text.c_str(), nullptr, 10);
+    return true;
+}
+
+} // namespace
+
+namespace solution {
+
+struct Server::Client {
+    uint64_t                m_id { 0 };
+    Output_t                m_output{};
+    // keeps the response lines whole
+    std::mutex              m_mutex;
+    // requests not answered yet, guarded by `m_mutex` of the server
+    size_t                  m_pending { 0 };
+    std::condition_variable m_idle;
+};
+
+Server::Server(size_t threads)
+    : m_workers(threads)
+{
+    assert(threads > 0 && "At least one worker is required");
+    for(auto& worker: m_workers) {
+        for(uint8_t player = 0; player < 2; player++) {
+            worker.m_solvers[kMinimax][player].reset(new Minimax { player });
+            worker.m_solvers[kAlphaBetta][player].reset(new AlphaBettaMinimax { player });
+            worker.m_solvers[kNegamax][player].reset(new Negamax { player });
+            // the settings of the interactive game
+            worker.m_solvers[kMCTS][player].reset(new MCTS { 16'666, 5'000, 10'000, player });
+            worker.m_solvers[kPerfectPlay][player].reset(new PerfectPlay { player });
+        }
+    }
+    m_threads.reserve(threads);
+    for(auto& worker: m_workers) {
+        m_threads.emplace_back([this, &worker]() {
+            this->Loop(worker);
+        });
+    }
+}
+
+Server::~Server() {
+    {
+        std::lock_guard<std::mutex> lock { m_mutex };
+        m_stopped = true;
+    }
+    m_ready.notify_all();
+    for(auto& thread: m_threads) {
+        thread.join();
+    }
+}
+
+std::shared_ptr<Server::Client> Server::Connect(Output_t && output) {
+    auto client = std::make_shared<Client>();
+    client->m_output = std::move(output);
+    std::lock_guard<std::mutex> lock { m_mutex };
+    client->m_id = m_clients++;
+    return client;
+}
+
+void Server::Submit(Client& client, const std::string& line) {
+    Request request;
+    request.m_received = Clock::now();
+    std::istringstream stream { line };
+    stream >> request.m_tag >> request.m_command;
+    for(std::string argument; stream >> argument;) {
+        request.m_arguments.push_back(std::move(argument));
+    }
+    if(request.m_tag.empty()) {
+        return;
+    }
+    m_requests.fetch_add(1, std::memory_order_relaxed);
+    if(request.m_command == "stats") {
+        this->Respond(client, request, "ok " + this->Stats());
+        return;
+    }
+    if(std::find(std::begin(SESSION_COMMANDS), std::end(SESSION_COMMANDS), request.m_command) == std::end(SESSION_COMMANDS)) {
+        this->Respond(client, request, "error unknown command");
+        return;
+    }
+    if(request.m_arguments.empty()) {
+        this->Respond(client, request, "error session expected");
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock { m_mutex };
+    const auto key = std::to_string(client.m_id) + ' ' + request.m_arguments.front();
+    auto& session = m_sessions[key];
+    if(!session) {
+        session = std::make_shared<Session>();
+        session->m_client = &client;
+        session->m_key = key;
+    }
+    session->m_queue.push_back(std::move(request));
+    client.m_pending++;
+    if(!session->m_scheduled) {
+        session->m_scheduled = true;
+        m_queue.push_back(session);
+        m_ready.notify_one();
+    }
+}
+
+void Server::Disconnect(Client& client) {
+    std::unique_lock<std::mutex> lock { m_mutex };
+    client.m_idle.wait(lock, [&client]() { return client.m_pending == 0; });
+    for(auto session = m_sessions.begin(); session != m_sessions.end();) {
+        session = session->second->m_client == &client? m_sessions.erase(session) : std::next(session);
+    }
+}
+
+void Server::Loop(Worker& worker) {
+    std::unique_lock<std::mutex> lock { m_mutex };
+    while(true) {
+        m_ready.wait(lock, [this]() { return m_stopped || !m_queue.empty(); });
+        if(m_queue.empty()) {
+            return;
+        }
+        // one request per turn: the sessions share the workers fairly
+        auto session = std::move(m_queue.front());
+        m_queue.pop_front();
+        const auto request = std::move(session->m_queue.front());
+        session->m_queue.pop_front();
+        lock.unlock();
+
+        const auto response = this->Execute(worker, *session, request);
+        this->Respond(*session->m_client, request, response);
+        if(request.m_command == "go" && response.compare(0, 2, "ok") == 0) {
+            const auto latency = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                Clock::now() - request.m_received).count());
+            m_moves.fetch_add(1, std::memory_order_relaxed);
+            m_latencySum.fetch_add(latency, std::memory_order_relaxed);
+            auto max = m_latencyMax.load(std::memory_order_relaxed);
+            while(max < latency && !m_latencyMax.compare_exchange_weak(max, latency, std::memory_order_relaxed)) {}
+        }
+
+        lock.lock();
+        if(!session->m_queue.empty()) {
+            m_queue.push_back(session);
+            m_ready.notify_one();
+        }
+        else {
+            session->m_scheduled = false;
+            // the finished (or never started) game is forgotten
+            if(!session->m_started) {
+                if(auto found = m_sessions.find(session->m_key); found != m_sessions.end() && found->second == session) {
+                    m_sessions.erase(found);
+                }
+            }
+        }
+        auto& client = *session->m_client;
+        if(--client.m_pending == 0) {
+            client.m_idle.notify_all();
+        }
+    }
+}
+
+std::string Server::Execute(Worker& worker, Session& session, const Request& request) {
+    const auto& arguments = request.m_arguments;
+    if(request.m_command == "new") {
+        if(session.m_started) {
+            return "error session exists";
+        }
+        if(arguments.size() != 3) {
+            return "error usage: new <session> <solver> <x|o>";
+        }
+        const auto kind = std::find(std::begin(KIND_NAMES), std::end(KIND_NAMES), arguments[1]);
+        if(kind == std::end(KIND_NAMES)) {
+            return "error unknown solver";
+        }
+        if(arguments[2] != "x" && arguments[2] != "o") {
+            return "error mark must be x or o";
+        }
+        session.m_started = true;
+        session.m_board = Board{};
+        session.m_kind = static_cast<Kind>(kind - std::begin(KIND_NAMES));
+        session.m_player = arguments[2] == "x"? 0 : 1;
+        return "ok";
+    }
+    if(!session.m_started) {
+        return "error unknown session";
+    }
+    if(request.m_command == "end") {
+        session.m_started = false;
+        return "ok";
+    }
+
+    auto& board = session.m_board;
+    if(game::GetGameState(board).first != Board::State::ONGOING) {
+        return "error game over";
+    }
+    if(request.m_command == "move") {
+        uint64_t cell { 0 };
+        if(arguments.size() != 2 || !ParseNumber(arguments[1], cell) || cell >= Board::SIZE) {
+            return "error usage: move <session> <cell>";
+        }
+        if(Mover(board) == session.m_player) {
+            return "error not the opponent's turn";
+        }
+        if(board.at(cell) != Board::Cell::FREE) {
+            return "error cell is occupied";
+        }
+        board.assign(cell, Mark(session.m_player ^ 1U));
+        return std::string { "ok " } + StateName(board);
+    }
+
+    // go
+    uint64_t budget { 0 };
+    if(arguments.size() > 2 || (arguments.size() == 2 && (!ParseNumber(arguments[1], budget) || !budget))) {
+        return "error usage: go <session> [budget_us]";
+    }
+    if(Mover(board) != session.m_player) {
+        return "error not the engine's turn";
+    }
+    auto& solver = *worker.m_solvers[session.m_kind][session.m_player];
+    const auto move = solver.Run(board, budget? Deadline::After(budget) : Deadline{});
+    board.assign(move, Mark(session.m_player));
+    return "ok " + std::to_string(move) + ' ' + StateName(board)
+        + " elapsed_us=" + std::to_string(solver.Elapsed())
+        + " nodes=" + std::to_string(solver.Nodes());
+}
+
+void Server::Respond(Client& client, const Request& request, const std::string& response) {
+    std::lock_guard<std::mutex> lock { client.m_mutex };
+    client.m_output(request.m_tag + ' ' + response);
+}
+
+std::string Server::Stats() const {
+    const auto moves = m_moves.load(std::memory_order_relaxed);
+    size_t sessions { 0 };
+    {
+        std::lock_guard<std::mutex> lock { m_mutex };
+        sessions = m_sessions.size();
+    }
+    return "requests=" + std::to_string(m_requests.load(std::memory_order_relaxed))
+        + " moves=" + std::to_string(moves)
+        + " sessions=" + std::to_string(sessions)
+        + " mean_us=" + std::to_string(moves? m_latencySum.load(std::memory_order_relaxed) / moves : 0)
+        + " max_us=" + std::to_string(m_latencyMax.load(std::memory_order_relaxed));
+}
+
+int ServeStdio(size_t threads) {
+    Server server { threads };
+    auto client = server.Connect([](const std::string& line) {
+        // the client waits for the response: no buffering
+        std::cout << line << std::endl;
+    });
+    for(std::string line; std::getline(std::cin, line);) {
+        server.Submit(*client, line);
+    }
+    server.Disconnect(*client);
+    return 0;
+}
+
+#ifdef _WIN32
+
+int ServeSocket(const std::string&, size_t) {
+    std::cerr << "Unix sockets aren't supported on this platform\n";
+    return 1;
+}
+
+#else
+
+namespace {
+
+void ServeConnection(Server& server, int connection) {
+    auto client = server.Connect([connection](const std::string& line) {
+        const auto data = line + '\n';
+        for(size_t sent = 0; sent < data.size();) {
+            const auto written = ::send(connection, data.data() + sent, data.size() - sent, 0);
+            if(written < 0 && errno == EINTR) {
+                continue;
+            }
+            // the client is gone: the rest of its responses are dropped
+            if(written <= 0) {
+                return;
+            }
+            sent += static_cast<size_t>(written);
+        }
+    });
+    char buffer[4096];
+    std::string input;
+    while(true) {
+        const auto received = ::read(connection, buffer, sizeof(buffer));
+        if(received < 0 && errno == EINTR) {
+            continue;
+        }
+        if(received <= 0) {
+            break;
+        }
+        input.append(buffer, static_cast<size_t>(received));
+        size_t first { 0 };
+        for(auto last = input.find('\n'); last != std::string::npos; last = input.find('\n', first)) {
+            server.Submit(*client, input.substr(first, last - first));
+            first = last + 1;
+        }
+        input.erase(0, first);
+    }
+    server.Disconnect(*client);
+    ::close(connection);
+}
+
+} // namespace
+
+int ServeSocket(const std::string& path, size_t threads) {
+    sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+    if(path.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Socket path is too long: " << path << "\n";
+        return 1;
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    const auto listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    ::unlink(path.c_str());
+    if(listener < 0
+        || ::bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0
+        || ::listen(listener, SOMAXCONN) != 0
+    ) {
+        std::cerr << "Can't listen on " << path << ": " << std::strerror(errno) << "\n";
+        if(listener >= 0) {
+            ::close(listener);
+        }
+        return 1;
+    }
+    // writing to a closed connection must fail instead of killing the server
+    std::signal(SIGPIPE, SIG_IGN);
+
+    Server server { threads };
+    std::mutex mutex;
+    std::condition_variable finished;
+    size_t connections { 0 };
+    while(true) {
+        const auto connection = ::accept(listener, nullptr, nullptr);
+        if(connection < 0 && errno == EINTR) {
+            continue;
+        }
+        if(connection < 0) {
+            std::cerr << "Can't accept a connection: " << std::strerror(errno) << "\n";
+            break;
+        }
+        {
+            std::lock_guard<std::mutex> lock { mutex };
+            connections++;
+        }
+        std::thread { [&server, &mutex, &finished, &connections, connection]() {
+            ServeConnection(server, connection);
+            std::lock_guard<std::mutex> lock { mutex };
+            connections--;
+            finished.notify_all();
+        } }.detach();
+    }
+    ::close(listener);
+    std::unique_lock<std::mutex> lock { mutex };
+    finished.wait(lock, [&connections]() { return connections == 0; });
+    return 1;
+}
+
+#endif
+
+} // namespace solution
+
+void TestServer() {
+    using solution::Server;
+    std::cerr << "Test the server...\n";
+    std::mutex mutex;
+    std::vector<std::string> responses;
+    Server server { 2 };
+    auto client = server.Connect([&mutex, &responses](const std::string& line) {
+        std::lock_guard<std::mutex> lock { mutex };
+        responses.push_back(line);
+    });
+    // pipelined: nothing waits for the responses
+    const char* requests[] = {
+        "1 new g alphabeta o", "2 move g 0", "3 go g", "4 move g 0", "5 new g mcts x",
+        "6 go h", "7 new p perfect x", "8 go p 1000", "9 end p", "10 go p", "11 fly g", "12 move g 9", ""
+    };
+    for(const auto request: requests) {
+        server.Submit(*client, request);
+    }
+    server.Disconnect(*client);
+
+    [[maybe_unused]] const auto response = [&responses](const std::string& tag) {
+        const auto found = std::find_if(responses.begin(), responses.end(), [&tag](const std::string& line) {
+            return line.compare(0, tag.size() + 1, tag + ' ') == 0;
+        });
+        assert(found != responses.end() && "Each request must be answered");
+        return found->substr(tag.size() + 1);
+    };
+    assert(responses.size() == std::size(requests) - 1 && "Each request must be answered once");
+    assert(response("1") == "ok");
+    assert(response("2") == "ok ongoing");
+    // the same move as the perfect play: the center
+    assert(response("3").compare(0, 13, "ok 4 ongoing ") == 0);
+    assert(response("4") == "error cell is occupied");
+    assert(response("5") == "error session exists");
+    assert(response("6") == "error unknown session");
+    assert(response("7") == "ok");
+    assert(response("8").compare(0, 13, "ok 0 ongoing ") == 0);
+    assert(response("9") == "ok");
+    assert(response("10") == "error unknown session");
+    assert(response("11") == "error unknown command");
+    assert(response("12") == "error usage: move <session> <cell>");
+    std::cerr << "Complete test.\n";
+}
@@ -0,0 +1,137 @@
+#ifndef SERVER_HPP_
+#define SERVER_HPP_
+
+#include "Solver.hpp"
+
+#include <condition_variable>
+#include <functional>
+#include <unordered_map>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <mutex>
+
+namespace solution {
+
+/**
+ * Headless engine speaking a line-oriented protocol. A request is
+ * `<tag> <command> [arguments]`, the response is `<tag> ok [results]`
+ * or `<tag> error <reason>`. The tag is chosen by the client to match
+ * the responses because requests are pipelined and answered out of order:
+ *   new <session> <solver> <x|o> - start a game, the engine plays the mark;
+ *                                  solver: minimax, alphabeta, negamax, mcts or perfect
+ *   move <session> <cell>        - the opponent's move (cell = row * 3 + col),
+ *                                  responds with the game state: ongoing, x, o (the winner) or draw
+ *   go <session> [budget_us]     - the engine's move: `<cell> <state> elapsed_us=<n> nodes=<n>`
+ *   end <session>                - forget the game
+ *   stats                        - counters of the server
+ * Requests of a session are executed in order, sessions are shared by the pool of workers.
+ * Each worker owns a solver of each kind for each player (as `BatchSolver`),
+ * so memory doesn't depend on the number of sessions.
+ */
+class Server final {
+public:
+    // receives the response lines (without the line end) of a client
+    using Output_t = std::function<void(const std::string&)>;
+
+    struct Client;
+
+    // @param threads number of workers executing the requests
+    explicit Server(size_t threads);
+
+    Server(const Server&) = delete;
+    Server& operator=(const Server&) = delete;
+
+    ~Server();
+
+    // the client's sessions are separate from the sessions of the other clients
+    std::shared_ptr<Client> Connect(Output_t && output);
+
+    // queue the request or answer it at once if it doesn't need a solver
+    void Submit(Client& client, const std::string& line);
+
+    // blocks until all requests of the client are answered, then forgets its sessions
+    void Disconnect(Client& client);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    enum Kind: uint8_t { kMinimax, kAlphaBetta, kNegamax, kMCTS, kPerfectPlay, KINDS };
+
+    struct Request {
+        std::string         m_tag;
+        std::string         m_command;
+        std::vector<std::string> m_arguments;
+        Clock::time_point   m_received{};
+    };
+
+    struct Session {
+        Client*             m_client { nullptr };
+        std::string         m_key;
+        // `new` was executed
+        bool                m_started { false };
+        Solver::State_t     m_board {};
+        Kind                m_kind { kAlphaBetta };
+        // the player of the engine: 0 - 'x', 1 - 'o'
+        uint8_t             m_player { 1 };
+        // the requests to execute, guarded by `m_mutex` of the server
+        std::deque<Request> m_queue{};
+        // the session is in the ready queue or executed by a worker
+        bool                m_scheduled { false };
+    };
+
+    struct Worker {
+        // [kind][player]
+        std::unique_ptr<Solver> m_solvers[KINDS][2];
+    };
+
+    void Loop(Worker& worker);
+
+    // @return the response without the tag
+    std::string Execute(Worker& worker, Session& session, const Request& request);
+
+    void Respond(Client& client, const Request& request, const std::string& response);
+
+    std::string Stats() const;
+
+    std::vector<Worker>         m_workers{};
+    std::vector<std::thread>    m_threads{};
+
+    // guards the sessions and the ready queue
+    mutable std::mutex          m_mutex;
+    std::condition_variable     m_ready;
+    std::deque<std::shared_ptr<Session>> m_queue{};
+    // key: client's id and session's name
+    std::unordered_map<std::string, std::shared_ptr<Session>> m_sessions{};
+    bool                        m_stopped { false };
+    uint64_t                    m_clients { 0 };
+
+    // statistics
+    std::atomic<uint64_t>       m_requests { 0 };
+    std::atomic<uint64_t>       m_moves { 0 };
+    // latency of `go` from receiving the request to the response (in microseconds)
+    std::atomic<uint64_t>       m_latencySum { 0 };
+    std::atomic<uint64_t>       m_latencyMax { 0 };
+};
+
+/**
+ * Serve one client reading the requests from stdin and writing the responses to stdout
+ * until the end of the input
+ */
+int ServeStdio(size_t threads);
+
+/**
+ * Serve the clients connected to the Unix socket at `path` (each in its own thread)
+ * until the process is stopped. Not supported on Windows
+ */
+int ServeSocket(const std::string& path, size_t threads);
+
+} // namespace solution
+
+void TestServer();
+
+#endif // SERVER_HPP_
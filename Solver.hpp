@@ -2,62 +2,68 @@
 #define SOLVER_HPP_
 
 #include "Board.hpp"
+#include "Deadline.hpp"
+#include "Game.hpp"
 
-#include <functional>
 #include <ostream>
 #include <cstdint>
 
 namespace solution {
 
-class Solver {
+/**
+ * Interface of the engines playing on the board `Board_t` (see `game::BasicBoard`)
+ * used by the callers choosing the engine at run time (tic-tac-toe is `Solver`).
+ * The engines themselves are templates over the game (see `BasicGame`):
+ * only `Run` and the statistics are virtual, the searches don't make virtual calls.
+ */
+template<class Board_t>
+class BasicSolver {
 public:
-    using State_t = game::Board;
-    using Mapping_t = std::function<State_t::Cell(uint8_t)>;
+    using State_t = Board_t;
 
-    /**
-     * @param player identity (basicaly correspond to his turn in the game)
-     * @param mapping maps player index to cell
-     */
-    Solver(uint8_t player, Mapping_t&& mapping)
+    // @param player identity (basicaly correspond to his turn in the game)
+    explicit BasicSolver(uint8_t player)
         : m_player { player }
-        , m_playerMapping { std::move(mapping) }
     {}
 
-    virtual ~Solver() = default;
+    virtual ~BasicSolver() = default;
 
     /**
      * Run minimax algorithm for the given board state
      * @param board is a current game state
      * @return the best move. To extract row and col do the following:
-     * - row = return_value / 3; 
-     * - col = return_value % 3
+     * - row = return_value / State_t::COLS;
+     * - col = return_value % State_t::COLS
      */
-    virtual size_t Run(State_t state) = 0;
+    size_t Run(State_t state) {
+        return this->Run(state, Deadline{});
+    }
 
-    virtual void Print(std::ostream& os) const = 0;
+    /**
+     * The same as above but the search is bounded
+     * @param deadline the search stops when it expires (checked once per a number of nodes)
+     * and the best move found so far is returned
+     */
+    virtual size_t Run(State_t state, const Deadline& deadline) = 0;
 
-protected:
+    virtual void Print(std::ostream& os) const = 0;
 
-    virtual bool IsTerminal(State_t state) const noexcept;
+    // positions looked through by the last `Run`: opened nodes of the searches, iterations of MCTS
+    virtual uint64_t Nodes() const noexcept = 0;
 
-    virtual uint8_t GetNextPlayer(uint8_t player) const noexcept;
+    // time spent by the last `Run` (in microseconds)
+    uint64_t Elapsed() const noexcept {
+        return m_elapsed;
+    }
 
 protected:
 
-    uint8_t     m_player{ 0 }; 
-    Mapping_t   m_playerMapping{};
+    uint8_t     m_player{ 0 };
     // Time spent by algorithm (in microseconds)
-    uint64_t    m_elapsed { 0 }; 
+    uint64_t    m_elapsed { 0 };
 };
 
-inline bool Solver::IsTerminal(State_t state) const noexcept {
-    // can't continue
-    return game::GetGameState(state).first != game::Board::State::ONGOING;
-}
-
-inline uint8_t Solver::GetNextPlayer(uint8_t player) const noexcept {
-    return ++player & 1;
-}
+using Solver = BasicSolver<game::Board>;
 
 } // namespace solver
 
@@ -0,0 +1,518 @@
+#include "Tablebase.hpp"
+#include "PerfectPlay.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace {
+
+using game::Board;
+using game::Board4x4;
+using game::Cell;
+using game::details::CountBits;
+using game::details::LowestBit;
+
+constexpr char MAGIC[8] = { 'T', 'T', 'T', 'B', 'A', 'S', 'E', '\0' };
+constexpr uint32_t VERSION { 1 };
+
+// entry: the move in the low bits, the value in the high ones
+constexpr uint8_t MOVE_MASK { 0x3F };
+constexpr unsigned VALUE_SHIFT { 6 };
+
+// a byte per position and two groups of scores are kept in memory while the table is built
+constexpr size_t MAX_CELLS { 20 };
+
+struct Header {
+    char        m_magic[8];
+    // the wrong byte order gives the wrong version
+    uint32_t    m_version;
+    uint8_t     m_rows;
+    uint8_t     m_cols;
+    uint8_t     m_line;
+    uint8_t     m_cells;
+    // number of entries following the header
+    uint64_t    m_size;
+};
+
+template<size_t CELLS>
+using Binomial_t = std::array<std::array<size_t, CELLS + 1>, CELLS + 1>;
+
+template<size_t CELLS>
+constexpr Binomial_t<CELLS> MakeBinomial() noexcept {
+    Binomial_t<CELLS> binomial {};
+    for(size_t n = 0; n <= CELLS; n++) {
+        binomial[n][0] = 1;
+        for(size_t k = 1; k <= n; k++) {
+            binomial[n][k] = binomial[n - 1][k - 1] + (k < n? binomial[n - 1][k] : 0);
+        }
+    }
+    return binomial;
+}
+
+template<size_t CELLS>
+constexpr auto BINOMIAL { MakeBinomial<CELLS>() };
+
+// number of marks of each player when the board has `marks` marks: 'x' moves first
+constexpr size_t XMarks(size_t marks) noexcept {
+    return (marks + 1) / 2;
+}
+
+constexpr size_t OMarks(size_t marks) noexcept {
+    return marks / 2;
+}
+
+template<size_t CELLS>
+constexpr size_t GroupSize(size_t marks) noexcept {
+    return BINOMIAL<CELLS>[CELLS][XMarks(marks)] * BINOMIAL<CELLS>[CELLS - XMarks(marks)][OMarks(marks)];
+}
+
+// [marks] - index of the first position with the number of marks, [CELLS + 1] - number of positions
+template<size_t CELLS>
+constexpr std::array<size_t, CELLS + 2> MakeGroups() noexcept {
+    std::array<size_t, CELLS + 2> groups {};
+    for(size_t marks = 0; marks <= CELLS; marks++) {
+        groups[marks + 1] = groups[marks] + GroupSize<CELLS>(marks);
+    }
+    return groups;
+}
+
+template<size_t CELLS>
+constexpr auto GROUPS { MakeGroups<CELLS>() };
+static_assert(GROUPS<Board::SIZE>[Board::SIZE + 1] == 6'046, "Unexpected number of positions");
+static_assert(GROUPS<Board4x4::SIZE>[Board4x4::SIZE + 1] == 10'165'779, "Unexpected number of positions");
+
+// rank among the masks with the same number of bits: colexicographic order (the numeric one)
+template<size_t CELLS>
+constexpr size_t RankMask(uint32_t mask) noexcept {
+    size_t rank { 0 };
+    for(size_t bits = 1; mask; bits++, mask &= mask - 1U) {
+        rank += BINOMIAL<CELLS>[LowestBit(mask)][bits];
+    }
+    return rank;
+}
+
+// pack the bits of `mask` at the positions of `cells` together
+constexpr uint32_t Compress(uint32_t mask, uint32_t cells) noexcept {
+    uint32_t packed { 0 };
+    for(uint32_t bit = 1; cells; bit <<= 1U, cells &= cells - 1U) {
+        if(mask & cells & (~cells + 1U)) {
+            packed |= bit;
+        }
+    }
+    return packed;
+}
+
+// inverse of `Compress`
+constexpr uint32_t Expand(uint32_t packed, uint32_t cells) noexcept {
+    uint32_t mask { 0 };
+    for(; cells; packed >>= 1U, cells &= cells - 1U) {
+        if(packed & 1U) {
+            mask |= cells & (~cells + 1U);
+        }
+    }
+    return mask;
+}
+
+// 'x' is ranked among all cells, 'o' among the cells free of 'x'
+template<class Board_t>
+constexpr size_t RankInGroup(uint32_t x, uint32_t o) noexcept {
+    constexpr auto CELLS { Board_t::SIZE };
+    const auto freeOfX = ~x & Board_t::FULL;
+    return RankMask<CELLS>(x) * BINOMIAL<CELLS>[CELLS - CountBits(x)][CountBits(o)]
+        + RankMask<CELLS>(Compress(o, freeOfX));
+}
+
+template<class Board_t>
+constexpr size_t ToIndex(Board_t board) noexcept {
+    const auto x = board.marks(Cell::X);
+    const auto o = board.marks(Cell::O);
+    return GROUPS<Board_t::SIZE>[CountBits(x) + CountBits(o)] + RankInGroup<Board_t>(x, o);
+}
+
+// the board of the players' masks (see `BasicBoard::unwrap`)
+template<class Board_t>
+constexpr Board_t ToBoard(uint32_t x, uint32_t o) noexcept {
+    return Board_t { x | (size_t { o } << Board_t::SIZE) };
+}
+
+// the first mask of `bits` bits and the next one in the numeric order (Gosper's hack)
+constexpr uint32_t FirstMask(size_t bits) noexcept {
+    return (1U << bits) - 1U;
+}
+
+constexpr uint32_t NextMask(uint32_t mask, size_t cells) noexcept {
+    if(!mask) {
+        return 1U << cells;
+    }
+    const auto lowest = mask & (~mask + 1U);
+    const auto ripple = mask + lowest;
+    return ripple | (((mask ^ ripple) >> 2U) / lowest);
+}
+
+static_assert(RankInGroup<Board>(0, 0) == 0 && ToIndex(Board{}) == 0);
+static_assert(ToIndex(ToBoard<Board>(0x1F0U, 0x00FU)) == GROUPS<Board::SIZE>[Board::SIZE + 1] - 1
+    , "The last full board must have the last index");
+static_assert(ToIndex(ToBoard<Board4x4>(0xFF00U, 0x00FFU)) == GROUPS<Board4x4::SIZE>[Board4x4::SIZE + 1] - 1
+    , "The last full board must have the last index");
+
+template<class Board_t>
+Header MakeHeader() noexcept {
+    Header header {};
+    std::memcpy(header.m_magic, MAGIC, sizeof(MAGIC));
+    header.m_version = VERSION;
+    header.m_rows = static_cast<uint8_t>(Board_t::ROWS);
+    header.m_cols = static_cast<uint8_t>(Board_t::COLS);
+    header.m_line = static_cast<uint8_t>(Board_t::LINE);
+    header.m_cells = static_cast<uint8_t>(Board_t::SIZE);
+    header.m_size = GROUPS<Board_t::SIZE>[Board_t::SIZE + 1];
+    return header;
+}
+
+/**
+ * @param bytes the size of the file
+ * @return the memory the file is mapped to
+ * @throw std::runtime_error when the file can't be mapped
+ */
+void* Map(const std::string& path, size_t& bytes) {
+#ifdef _WIN32
+    auto file = ::CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if(file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error { "Can't open " + path };
+    }
+    LARGE_INTEGER size {};
+    ::GetFileSizeEx(file, &size);
+    bytes = static_cast<size_t>(size.QuadPart);
+    auto mapping = bytes? ::CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+    ::CloseHandle(file);
+    // the view keeps the mapping alive
+    auto memory = mapping? ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if(mapping) {
+        ::CloseHandle(mapping);
+    }
+    if(!memory) {
+        throw std::runtime_error { "Can't map " + path };
+    }
+    return memory;
+#else
+    const auto file = ::open(path.c_str(), O_RDONLY);
+    if(file < 0) {
+        throw std::runtime_error { "Can't open " + path };
+    }
+    struct stat status {};
+    ::fstat(file, &status);
+    bytes = static_cast<size_t>(status.st_size);
+    auto memory = bytes? ::mmap(nullptr, bytes, PROT_READ, MAP_SHARED, file, 0) : MAP_FAILED;
+    // the mapping keeps the file open
+    ::close(file);
+    if(memory == MAP_FAILED) {
+        throw std::runtime_error { "Can't map " + path };
+    }
+    return memory;
+#endif
+}
+
+void Unmap(void* memory, size_t bytes) noexcept {
+#ifdef _WIN32
+    (void) bytes;
+    ::UnmapViewOfFile(memory);
+#else
+    ::munmap(memory, bytes);
+#endif
+}
+
+} // namespace
+
+namespace solution {
+
+template<class Board_t>
+void BuildTablebase(const std::string& path) {
+    constexpr auto CELLS { Board_t::SIZE };
+    static_assert(CELLS <= MAX_CELLS, "The tablebase of the board doesn't fit into memory");
+    static_assert(CELLS <= MOVE_MASK, "The move doesn't fit the entry");
+    // value of the win/loss for the terminal state, the same as `Minimax::GetHeuristic`
+    constexpr int WIN_SCORE { static_cast<int>(CELLS) + 11 };
+    constexpr auto& binomial = BINOMIAL<CELLS>;
+
+    std::ofstream file { path, std::ios::binary | std::ios::trunc };
+    if(!file) {
+        throw std::runtime_error { "Can't create " + path };
+    }
+    const auto header = MakeHeader<Board_t>();
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    // ranks of all masks: the children are ranked by look ups instead of the loops of `RankMask`
+    std::vector<uint32_t> ranks(size_t { 1 } << CELLS);
+    for(uint32_t mask = 0; mask < ranks.size(); mask++) {
+        ranks[mask] = static_cast<uint32_t>(RankMask<CELLS>(mask));
+    }
+    // scores for the player to move (see `PerfectPlay::Evaluate`): of the next group and of the current one
+    std::vector<int8_t> next;
+    std::vector<int8_t> current;
+    std::vector<uint8_t> entries;
+    for(size_t marks = CELLS + 1; marks-- > 0;) {
+        const auto xMarks = XMarks(marks);
+        const auto oMarks = OMarks(marks);
+        // 'x' - 0, 'o' - 1
+        const auto mover = marks % 2;
+        // the number of 'o' placements of the child for each placement of 'x'
+        const auto childPlacements = mover == 0? binomial[CELLS - xMarks - 1][oMarks] : binomial[CELLS - xMarks][oMarks + 1];
+        current.assign(GroupSize<CELLS>(marks), 0);
+        entries.assign(GroupSize<CELLS>(marks), 0);
+        // positions are enumerated in the order of their ranks
+        size_t rank { 0 };
+        for(auto x = FirstMask(xMarks); x < (1U << CELLS); x = NextMask(x, CELLS)) {
+            const uint32_t freeOfX = ~x & Board_t::FULL;
+            for(auto packed = FirstMask(oMarks); packed < (1U << (CELLS - xMarks)); packed = NextMask(packed, CELLS - xMarks)) {
+                const auto o = Expand(packed, freeOfX);
+                assert(RankInGroup<Board_t>(x, o) == rank && "Positions must be enumerated by ranks");
+                const auto freeCells = freeOfX & ~o;
+                const auto [state, winner] = game::GetGameState(ToBoard<Board_t>(x, o));
+                // the first free cell when all moves are equal as `PerfectPlay` does
+                size_t move { freeCells? LowestBit(freeCells) : 0 };
+                int best { 0 };
+                if(state == game::State::WIN) {
+                    const auto score = static_cast<int>(WIN_SCORE + CountBits(freeCells));
+                    best = static_cast<size_t>(winner) == mover? score : -score;
+                }
+                else if(state == game::State::ONGOING) {
+                    best = -WIN_SCORE * 2;
+                    for(const auto i: game::Cells { freeCells }) {
+                        // the cell is the `k`-th of the cells free of 'x': the bit of 'o' among them
+                        const auto below = (1U << CountBits(freeOfX & ((1U << i) - 1U))) - 1U;
+                        const auto child = mover == 0
+                            // the cell is no longer free of 'x': the bits of 'o' above it move down
+                            ? ranks[x | (1U << i)] * childPlacements + ranks[(packed & below) | ((packed >> 1U) & ~below)]
+                            : ranks[x] * childPlacements + ranks[packed | (below + 1U)];
+                        const auto value = -next[child];
+                        if(best < value) {
+                            best = value;
+                            move = i;
+                        }
+                    }
+                }
+                const auto value = best > 0? BasicTablebase<Board_t>::Value::WIN
+                    : best < 0? BasicTablebase<Board_t>::Value::LOSS
+                    : BasicTablebase<Board_t>::Value::DRAW;
+                current[rank] = static_cast<int8_t>(best);
+                entries[rank] = static_cast<uint8_t>(move | (static_cast<unsigned>(value) << VALUE_SHIFT));
+                rank++;
+            }
+        }
+        file.seekp(static_cast<std::streamoff>(sizeof(Header) + GROUPS<CELLS>[marks]));
+        file.write(reinterpret_cast<const char*>(entries.data()), static_cast<std::streamsize>(entries.size()));
+        std::swap(next, current);
+    }
+    file.close();
+    if(!file) {
+        throw std::runtime_error { "Can't write " + path };
+    }
+}
+
+template<class Board_t>
+BasicTablebase<Board_t>::BasicTablebase(const std::string& path) {
+    m_mapping = Map(path, m_bytes);
+    const auto expected = MakeHeader<Board_t>();
+    Header header {};
+    if(m_bytes >= sizeof(header)) {
+        std::memcpy(&header, m_mapping, sizeof(header));
+    }
+    if(m_bytes < sizeof(header)
+        || std::memcmp(header.m_magic, MAGIC, sizeof(MAGIC)) != 0
+        || header.m_version != VERSION
+        || header.m_rows != expected.m_rows || header.m_cols != expected.m_cols
+        || header.m_line != expected.m_line || header.m_cells != expected.m_cells
+        || header.m_size != expected.m_size
+        || m_bytes != sizeof(header) + header.m_size
+    ) {
+        Unmap(m_mapping, m_bytes);
+        throw std::runtime_error { path + " isn't a tablebase of this board" };
+    }
+    m_entries = static_cast<const uint8_t*>(m_mapping) + sizeof(header);
+    m_size = static_cast<size_t>(header.m_size);
+}
+
+template<class Board_t>
+BasicTablebase<Board_t>::~BasicTablebase() {
+    Unmap(m_mapping, m_bytes);
+}
+
+template<class Board_t>
+typename BasicTablebase<Board_t>::Entry BasicTablebase<Board_t>::Probe(Board_t board) const noexcept {
+    assert(CountBits(board.marks(Cell::X)) - CountBits(board.marks(Cell::O)) <= 1
+        && "'x' must have as many marks as 'o' or one more");
+    const auto entry = m_entries[ToIndex(board)];
+    return Entry { static_cast<Value>(entry >> VALUE_SHIFT), static_cast<size_t>(entry & MOVE_MASK) };
+}
+
+template<class Game_t>
+BasicTablebasePlay<Game_t>::BasicTablebasePlay(
+    uint8_t player
+    , std::shared_ptr<const Table_t> table
+)
+    : Solver_t { player }
+    , m_table { std::move(table) }
+{
+    assert(m_player <= 1);
+    assert(m_table && "The table is required");
+}
+
+template<class Game_t>
+size_t BasicTablebasePlay<Game_t>::Run(State_t board, const Deadline&) {
+    const auto start = std::chrono::system_clock::now();
+    assert(static_cast<size_t>(Game_t::Mark(m_player))
+        == (CountBits(board.marks(Cell::X)) + CountBits(board.marks(Cell::O))) % 2
+        && "The player must be the one to move");
+    const auto entry = m_table->Probe(board);
+    m_value = entry.m_value;
+    const auto end = std::chrono::system_clock::now();
+    const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    m_elapsed = static_cast<uint64_t>(elapsed);
+    return entry.m_move;
+}
+
+template<class Game_t>
+void BasicTablebasePlay<Game_t>::Print(std::ostream& os) const {
+    const char* values[] = { "draw", "win", "loss" };
+    os << "Look through: 1 node\n";
+    os << "Value: " << values[static_cast<size_t>(m_value)] << "\n";
+    os << "Elapsed time: " << m_elapsed / 1'000.f << " ms\n";
+}
+
+template void BuildTablebase<game::Board>(const std::string&);
+template void BuildTablebase<game::Board4x4>(const std::string&);
+template class BasicTablebase<game::Board>;
+template class BasicTablebase<game::Board4x4>;
+template class BasicTablebasePlay<TicTacToe>;
+template class BasicTablebasePlay<BasicGame<game::Board4x4>>;
+
+} // namespace solution
+
+namespace {
+
+// every board with the legal number of marks has its own index, the values agree with the perfect play
+void TestTablebase3x3(const std::string& path) {
+    using solution::Tablebase;
+    solution::BuildTablebase<Board>(path);
+    auto table = std::make_shared<const Tablebase>(path);
+    assert(table->Size() == GROUPS<Board::SIZE>[Board::SIZE + 1]);
+    solution::PerfectPlay perfect[2] = { solution::PerfectPlay { 0 }, solution::PerfectPlay { 1 } };
+    solution::TablebasePlay tablebase[2] = { { 0, table }, { 1, table } };
+
+    std::vector<bool> indexed(table->Size(), false);
+    for(uint32_t x = 0; x <= Board::FULL; x++) {
+        const auto freeOfX = ~x & Board::FULL;
+        // all subsets of the cells free of 'x'
+        for(auto o = freeOfX; ; o = (o - 1U) & freeOfX) {
+            const auto xMarks = CountBits(x);
+            const auto oMarks = CountBits(o);
+            if(xMarks == oMarks || xMarks == oMarks + 1) {
+                const auto board = ToBoard<Board>(x, o);
+                const auto index = ToIndex(board);
+                assert(index < table->Size() && !indexed[index] && "The index must be perfect");
+                indexed[index] = true;
+                const auto player = static_cast<size_t>(xMarks != oMarks);
+                const auto value = perfect[player].Evaluate(board);
+                [[maybe_unused]] const auto expected = value > 0? Tablebase::Value::WIN
+                    : value < 0? Tablebase::Value::LOSS
+                    : Tablebase::Value::DRAW;
+                assert(table->Probe(board).m_value == expected && "Tablebase disagrees with the perfect play");
+                assert(tablebase[player].Run(board) == perfect[player].Run(board)
+                    && "Tablebase disagrees with the perfect play");
+            }
+            if(o == 0) {
+                break;
+            }
+        }
+    }
+    assert(std::find(indexed.begin(), indexed.end(), false) == indexed.end() && "The index must be minimal");
+}
+
+// the file of the test: unique for the process and removed on every exit path
+class TemporaryFile final {
+public:
+    TemporaryFile()
+        : m_path { (std::filesystem::temp_directory_path() / ("tic-tac-toe-test-" + std::to_string(ProcessId()) + ".tablebase")).string() }
+    {}
+
+    TemporaryFile(const TemporaryFile&) = delete;
+    TemporaryFile& operator=(const TemporaryFile&) = delete;
+
+    ~TemporaryFile() {
+        std::error_code error;
+        std::filesystem::remove(m_path, error);
+    }
+
+    const std::string& Path() const noexcept {
+        return m_path;
+    }
+
+private:
+    static unsigned long ProcessId() noexcept {
+#ifdef _WIN32
+        return static_cast<unsigned long>(::GetCurrentProcessId());
+#else
+        return static_cast<unsigned long>(::getpid());
+#endif
+    }
+
+    std::string m_path;
+};
+
+} // namespace
+
+void TestTablebase() {
+    using solution::Tablebase;
+    std::cerr << "Test the tablebase...\n";
+    // the game starts even if the file can't be written
+    try {
+        const TemporaryFile file;
+        TestTablebase3x3(file.Path());
+
+        // the table of another board is rejected
+        [[maybe_unused]] bool rejected { false };
+        try {
+            solution::BasicTablebase<Board4x4> other { file.Path() };
+        }
+        catch(const std::runtime_error&) {
+            rejected = true;
+        }
+        assert(rejected && "The table of another board must be rejected");
+
+        // as well as a truncated one
+        std::filesystem::resize_file(file.Path(), sizeof(Header) + 1);
+        rejected = false;
+        try {
+            Tablebase truncated { file.Path() };
+        }
+        catch(const std::runtime_error&) {
+            rejected = true;
+        }
+        assert(rejected && "The truncated file must be rejected");
+    }
+    catch(const std::runtime_error& error) {
+        std::cerr << "Skipped: " << error.what() << "\n";
+        return;
+    }
+    std::cerr << "Complete test.\n";
+}
@@ -0,0 +1,123 @@
+#ifndef TABLEBASE_HPP_
+#define TABLEBASE_HPP_
+
+#include "Solver.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace solution {
+
+/**
+ * Values and best moves of all positions of the board `Board_t` (see `game::BasicBoard`)
+ * solved offline (see `BuildTablebase`) and mapped into memory read-only: nothing is parsed
+ * at startup, a look up is O(1) and the pages are shared by all processes mapping the same file.
+ * The file is a header followed by one byte per position: positions are grouped
+ * by the number of marks and ranked inside the group (a minimal perfect index).
+ * Multi-byte fields are stored in the native byte order, the header is checked on open.
+ * Built for tic-tac-toe (6'046 positions) and 4x4 (10'165'779 positions).
+ */
+template<class Board_t>
+class BasicTablebase final {
+public:
+    // for the player who makes the next move
+    enum class Value: uint8_t { DRAW, WIN, LOSS };
+
+    struct Entry {
+        Value   m_value { Value::DRAW };
+        // the fastest win or the slowest loss, the first free cell for finished games
+        size_t  m_move { 0 };
+    };
+
+    /**
+     * @param path file written by `BuildTablebase<Board_t>`
+     * @throw std::runtime_error when the file can't be mapped or is built for another board
+     */
+    explicit BasicTablebase(const std::string& path);
+
+    BasicTablebase(const BasicTablebase&) = delete;
+    BasicTablebase& operator=(const BasicTablebase&) = delete;
+
+    ~BasicTablebase();
+
+    /**
+     * @param board position where 'x' (moves first) has as many marks as 'o' or one more,
+     * the player to move is defined by the number of marks
+     */
+    Entry Probe(Board_t board) const noexcept;
+
+    // number of positions in the table
+    size_t Size() const noexcept {
+        return m_size;
+    }
+
+private:
+    void*           m_mapping { nullptr };
+    size_t          m_bytes { 0 };
+    const uint8_t*  m_entries { nullptr };
+    size_t          m_size { 0 };
+};
+
+using Tablebase = BasicTablebase<game::Board>;
+
+/**
+ * Solve all positions of the board `Board_t` by retrograde analysis and write the table for `BasicTablebase`.
+ * Positions are processed by the number of marks from the full boards down to the empty one:
+ * only two adjacent groups are kept in memory and each group is written once.
+ * @throw std::runtime_error on I/O errors
+ */
+template<class Board_t>
+void BuildTablebase(const std::string& path);
+
+/**
+ * Perfect player of the game `Game_t` (see `BasicGame`) backed by the memory-mapped `BasicTablebase`.
+ * On tic-tac-toe it chooses the same moves as `PerfectPlay`.
+ */
+template<class Game_t>
+class BasicTablebasePlay final : public BasicSolver<typename Game_t::State_t> {
+public:
+    using Solver_t = BasicSolver<typename Game_t::State_t>;
+    using typename Solver_t::State_t;
+    using Table_t = BasicTablebase<State_t>;
+
+    /**
+     * @param player identity (basicaly correspond to his turn in the game), mapped to the mark by `Game_t`
+     * @param table is shared by the solvers of both players
+     */
+    BasicTablebasePlay(uint8_t player, std::shared_ptr<const Table_t> table);
+
+    /**
+     * Look up the best move for the given board state
+     * @param board is a current game state, the player must be the one to move
+     * @param deadline is ignored: the look up takes no time
+     * @return the best move. To extract row and col do the following:
+     * - row = return_value / State_t::COLS;
+     * - col = return_value % State_t::COLS
+     */
+    size_t Run(State_t state, const Deadline& deadline) override;
+
+    using Solver_t::Run;
+
+    void Print(std::ostream& os) const override;
+
+    uint64_t Nodes() const noexcept override {
+        return 1;
+    }
+
+private:
+    using Solver_t::m_player;
+    using Solver_t::m_elapsed;
+
+    std::shared_ptr<const Table_t> m_table{};
+    // of the last `Run`
+    typename Table_t::Value m_value { Table_t::Value::DRAW };
+};
+
+using TablebasePlay = BasicTablebasePlay<TicTacToe>;
+
+} // namespace solution
+
+void TestTablebase();
+
+#endif // TABLEBASE_HPP_
@@ -0,0 +1,403 @@
+#include "Board.hpp"
+#include "Minimax.hpp"
+#include "Negamax.hpp"
+#include "MCTS.hpp"
+#include "PerfectPlay.hpp"
+#include "Random.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Self-play tournament between two solver configurations, the games are played in parallel.
+ * Usage: tic-tac-toe-tournament <config> <config> [--games N] [--threads N] [--openings N] [--format json|csv]
+ * A configuration is `<solver>[:key=value,...]`:
+ *   minimax, alphabeta[:time=US], negamax[:mode=pvs|mtdf], perfect,
+ *   mcts[:time=US,iterations=N,tree=N,rave=K,symmetric=0|1]
+ * and any of them takes `budget=US`: the deadline of each move.
+ * The configurations alternate the first move, the first `openings` plies of each game are random
+ * (seeded by the game's number) so the deterministic solvers don't repeat the same game.
+ * The report (stdout) has the results, the latency and nodes per move of each configuration
+ * and its blunders: moves worsening the game-theoretic result according to the perfect play.
+ */
+
+namespace {
+
+using game::Board;
+using Clock = std::chrono::steady_clock;
+using solution::Solver;
+
+struct Config {
+    std::string m_spec;
+    std::string m_kind;
+    // the solver's own time limit (alphabeta, mcts)
+    uint64_t    m_time { 0 };
+    uint64_t    m_iterations { 5'000 };
+    uint64_t    m_tree { 10'000 };
+    uint32_t    m_rave { 0 };
+    // merge symmetric children (mcts)
+    bool        m_symmetric { false };
+    solution::Negamax::Mode m_mode { solution::Negamax::Mode::PVS };
+    // the deadline of each move, 0 - none
+    uint64_t    m_budget { 0 };
+
+    // @throw std::invalid_argument for unknown solvers or keys
+    static Config Parse(const std::string& spec) {
+        Config config;
+        config.m_spec = spec;
+        const auto colon = spec.find(':');
+        config.m_kind = spec.substr(0, colon);
+        if(config.m_kind == "mcts") {
+            config.m_time = 16'666;
+        }
+        for(size_t first = colon; first != std::string::npos && first + 1 < spec.size();) {
+            const auto last = spec.find(',', first + 1);
+            const auto option = spec.substr(first + 1, last == std::string::npos? std::string::npos : last - first - 1);
+            first = last;
+            const auto equal = option.find('=');
+            if(equal == std::string::npos) {
+                throw std::invalid_argument { "expected key=value: " + option };
+            }
+            const auto key = option.substr(0, equal);
+            const auto value = option.substr(equal + 1);
+            if(key == "mode" && config.m_kind == "negamax") {
+                if(value != "pvs" && value != "mtdf") {
+                    throw std::invalid_argument { "unknown mode: " + value };
+                }
+                config.m_mode = value == "mtdf"? solution::Negamax::Mode::MTDF : solution::Negamax::Mode::PVS;
+                continue;
+            }
+            const auto number = std::stoull(value);
+            if(key == "budget") {
+                config.m_budget = number;
+            }
+            else if(key == "time" && (config.m_kind == "alphabeta" || config.m_kind == "mcts")) {
+                config.m_time = number;
+            }
+            else if(key == "iterations" && config.m_kind == "mcts") {
+                config.m_iterations = number;
+            }
+            else if(key == "tree" && config.m_kind == "mcts") {
+                config.m_tree = number;
+            }
+            else if(key == "rave" && config.m_kind == "mcts") {
+                config.m_rave = static_cast<uint32_t>(number);
+            }
+            else if(key == "symmetric" && config.m_kind == "mcts") {
+                config.m_symmetric = number != 0;
+            }
+            else {
+                throw std::invalid_argument { "unknown option of " + config.m_kind + ": " + key };
+            }
+        }
+        // fail before the games start
+        Create(config, 0);
+        return config;
+    }
+
+    static std::unique_ptr<Solver> Create(const Config& config, uint8_t player) {
+        using namespace solution;
+        if(config.m_kind == "minimax") {
+            return std::make_unique<Minimax>(player);
+        }
+        if(config.m_kind == "alphabeta") {
+            return std::make_unique<AlphaBettaMinimax>(player, config.m_time);
+        }
+        if(config.m_kind == "negamax") {
+            return std::make_unique<Negamax>(player, config.m_mode);
+        }
+        if(config.m_kind == "perfect") {
+            return std::make_unique<PerfectPlay>(player);
+        }
+        if(config.m_kind == "mcts") {
+            return std::make_unique<MCTS>(config.m_time, config.m_iterations, config.m_tree
+                , player, 1, 1, config.m_rave, config.m_symmetric);
+        }
+        throw std::invalid_argument { "unknown solver: " + config.m_kind };
+    }
+};
+
+// results of one configuration
+struct Side {
+    size_t  m_wins { 0 };
+    size_t  m_draws { 0 };
+    size_t  m_losses { 0 };
+    size_t  m_blunders { 0 };
+    // per move
+    std::vector<double>     m_latencies{};
+    std::vector<uint64_t>   m_nodes{};
+
+    void Merge(const Side& other) {
+        m_wins += other.m_wins;
+        m_draws += other.m_draws;
+        m_losses += other.m_losses;
+        m_blunders += other.m_blunders;
+        m_latencies.insert(m_latencies.end(), other.m_latencies.begin(), other.m_latencies.end());
+        m_nodes.insert(m_nodes.end(), other.m_nodes.begin(), other.m_nodes.end());
+    }
+};
+
+template<class T>
+T Percentile(const std::vector<T>& sorted, double p) {
+    if(sorted.empty()) {
+        return T{};
+    }
+    return sorted[static_cast<size_t>(p * static_cast<double>(sorted.size() - 1) + 0.5)];
+}
+
+template<class T>
+double Mean(const std::vector<T>& values) {
+    double sum { 0. };
+    for(const auto value: values) {
+        sum += static_cast<double>(value);
+    }
+    return values.empty()? 0. : sum / static_cast<double>(values.size());
+}
+
+/**
+ * Plays the games of one thread, each configuration has a solver for each player
+ */
+class Arena final {
+public:
+    explicit Arena(const Config (&configs)[2]) {
+        for(size_t side = 0; side < 2; side++) {
+            m_budgets[side] = configs[side].m_budget;
+            for(uint8_t player = 0; player < 2; player++) {
+                m_solvers[side][player] = Config::Create(configs[side], player);
+            }
+        }
+    }
+
+    // configuration 0 moves first in the even games
+    void Play(size_t game, size_t openings) {
+        solution::Xorshift32 random { static_cast<uint32_t>(game / 2 + 1) * 0x9E3779B9u };
+        const size_t first { game % 2 };
+        Board board {};
+        uint8_t player { 0 };
+        for(; game::GetGameState(board).first == Board::State::ONGOING; player ^= 1) {
+            const game::Cells moves { board.freeCells() };
+            size_t move { 0 };
+            if(openings > 0) {
+                openings--;
+                move = solution::RandomCell(moves, random);
+            }
+            else {
+                const size_t side { player == 0? first : first ^ 1 };
+                auto& solver = *m_solvers[side][player];
+                const auto deadline = m_budgets[side]?
+                    solution::Deadline::After(m_budgets[side]) : solution::Deadline{};
+                const auto start = Clock::now();
+                move = solver.Run(board, deadline);
+                const auto duration = Clock::now() - start;
+                m_sides[side].m_latencies.push_back(static_cast<double>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()) * 1e-3);
+                m_sides[side].m_nodes.push_back(solver.Nodes());
+                m_sides[side].m_blunders += solution::MoveValue(board, player, move) < Best(board, player);
+            }
+            board.assign(move, solution::TicTacToe::Mark(player));
+        }
+        const auto [state, winner] = game::GetGameState(board);
+        if(state == Board::State::DRAW) {
+            m_sides[0].m_draws++;
+            m_sides[1].m_draws++;
+            return;
+        }
+        const size_t side { winner == Board::Cell::X? first : first ^ 1 };
+        m_sides[side].m_wins++;
+        m_sides[side ^ 1].m_losses++;
+    }
+
+    const Side& Results(size_t side) const noexcept {
+        return m_sides[side];
+    }
+
+private:
+    // the best result of the moves for the player who makes one, see `solution::MoveValue`
+    static int Best(Board board, uint8_t player) noexcept {
+        auto best = -1;
+        for(const auto cell: game::Cells { board.freeCells() }) {
+            best = std::max(best, solution::MoveValue(board, player, cell));
+        }
+        return best;
+    }
+
+    // [configuration][player]
+    std::unique_ptr<Solver> m_solvers[2][2];
+    uint64_t    m_budgets[2] { 0, 0 };
+    Side        m_sides[2]{};
+};
+
+struct Report {
+    std::string m_config;
+    size_t      m_games { 0 };
+    double      m_winRate { 0. };
+    double      m_drawRate { 0. };
+    double      m_lossRate { 0. };
+    size_t      m_moves { 0 };
+    size_t      m_blunders { 0 };
+    // latency of a move in microseconds
+    double      m_mean { 0. };
+    double      m_p50 { 0. };
+    double      m_p90 { 0. };
+    double      m_p99 { 0. };
+    double      m_max { 0. };
+    // nodes per move
+    double      m_nodesMean { 0. };
+    uint64_t    m_nodesP50 { 0 };
+    uint64_t    m_nodesP99 { 0 };
+    uint64_t    m_nodesMax { 0 };
+};
+
+Report MakeReport(const Config& config, Side& side) {
+    std::sort(side.m_latencies.begin(), side.m_latencies.end());
+    std::sort(side.m_nodes.begin(), side.m_nodes.end());
+    Report report;
+    report.m_config = config.m_spec;
+    report.m_games = side.m_wins + side.m_draws + side.m_losses;
+    const auto games = static_cast<double>(std::max<size_t>(1, report.m_games));
+    report.m_winRate = static_cast<double>(side.m_wins) / games;
+    report.m_drawRate = static_cast<double>(side.m_draws) / games;
+    report.m_lossRate = static_cast<double>(side.m_losses) / games;
+    report.m_moves = side.m_latencies.size();
+    report.m_blunders = side.m_blunders;
+    report.m_mean = Mean(side.m_latencies);
+    report.m_p50 = Percentile(side.m_latencies, 0.5);
+    report.m_p90 = Percentile(side.m_latencies, 0.9);
+    report.m_p99 = Percentile(side.m_latencies, 0.99);
+    report.m_max = side.m_latencies.empty()? 0. : side.m_latencies.back();
+    report.m_nodesMean = Mean(side.m_nodes);
+    report.m_nodesP50 = Percentile(side.m_nodes, 0.5);
+    report.m_nodesP99 = Percentile(side.m_nodes, 0.99);
+    report.m_nodesMax = side.m_nodes.empty()? 0 : side.m_nodes.back();
+    return report;
+}
+
+void PrintJson(const std::vector<Report>& reports) {
+    std::cout << "[\n";
+    for(size_t i = 0; i < reports.size(); i++) {
+        const auto& report = reports[i];
+        std::cout << "  { \"config\": \"" << report.m_config << "\""
+            << ", \"games\": " << report.m_games
+            << ", \"win_rate\": " << report.m_winRate
+            << ", \"draw_rate\": " << report.m_drawRate
+            << ", \"loss_rate\": " << report.m_lossRate
+            << ", \"moves\": " << report.m_moves
+            << ", \"blunders\": " << report.m_blunders
+            << ", \"mean_us\": " << report.m_mean
+            << ", \"p50_us\": " << report.m_p50
+            << ", \"p90_us\": " << report.m_p90
+            << ", \"p99_us\": " << report.m_p99
+            << ", \"max_us\": " << report.m_max
+            << ", \"nodes_mean\": " << report.m_nodesMean
+            << ", \"nodes_p50\": " << report.m_nodesP50
+            << ", \"nodes_p99\": " << report.m_nodesP99
+            << ", \"nodes_max\": " << report.m_nodesMax
+            << " }" << (i + 1 < reports.size()? ",\n" : "\n");
+    }
+    std::cout << "]\n";
+}
+
+void PrintCsv(const std::vector<Report>& reports) {
+    std::cout << "config,games,win_rate,draw_rate,loss_rate,moves,blunders,mean_us,p50_us,p90_us,p99_us,max_us"
+        << ",nodes_mean,nodes_p50,nodes_p99,nodes_max\n";
+    for(const auto& report: reports) {
+        // the configurations contain commas
+        std::cout << '"' << report.m_config << '"' << ',' << report.m_games
+            << ',' << report.m_winRate << ',' << report.m_drawRate << ',' << report.m_lossRate
+            << ',' << report.m_moves << ',' << report.m_blunders
+            << ',' << report.m_mean << ',' << report.m_p50 << ',' << report.m_p90 << ',' << report.m_p99
+            << ',' << report.m_max
+            << ',' << report.m_nodesMean << ',' << report.m_nodesP50 << ',' << report.m_nodesP99
+            << ',' << report.m_nodesMax << '\n';
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const auto usage = [argv]() {
+        std::cerr << "Usage: " << argv[0] << " <config> <config> [--games N] [--threads N] [--openings N]"
+            << " [--format json|csv]\n"
+            << "  config: minimax | alphabeta[:time=US] | negamax[:mode=pvs|mtdf] | perfect"
+            << " | mcts[:time=US,iterations=N,tree=N,rave=K,symmetric=0|1], all take budget=US\n";
+        return 1;
+    };
+    if(argc < 3) {
+        return usage();
+    }
+    Config configs[2];
+    size_t games { 1'000 };
+    size_t threads { std::max(1u, std::thread::hardware_concurrency()) };
+    size_t openings { 2 };
+    bool csv { false };
+    try {
+        configs[0] = Config::Parse(argv[1]);
+        configs[1] = Config::Parse(argv[2]);
+        for(int i = 3; i < argc; i++) {
+            const std::string arg { argv[i] };
+            if(i + 1 >= argc) {
+                return usage();
+            }
+            const std::string value { argv[++i] };
+            if(arg == "--games") {
+                games = std::max<size_t>(1, std::stoul(value));
+            }
+            else if(arg == "--threads") {
+                threads = std::max<size_t>(1, std::stoul(value));
+            }
+            else if(arg == "--openings") {
+                openings = std::stoul(value);
+            }
+            else if(arg == "--format" && (value == "json" || value == "csv")) {
+                csv = value == "csv";
+            }
+            else {
+                return usage();
+            }
+        }
+    }
+    catch(const std::exception& error) {
+        std::cerr << error.what() << "\n";
+        return usage();
+    }
+
+    Side sides[2];
+    std::mutex mutex;
+    std::atomic<size_t> next { 0 };
+    std::vector<std::thread> workers;
+    const auto start = Clock::now();
+    for(size_t i = 0; i < std::min(threads, games); i++) {
+        workers.emplace_back([&]() {
+            Arena arena { configs };
+            for(auto game = next++; game < games; game = next++) {
+                arena.Play(game, openings);
+            }
+            std::lock_guard<std::mutex> lock { mutex };
+            sides[0].Merge(arena.Results(0));
+            sides[1].Merge(arena.Results(1));
+        });
+    }
+    for(auto& worker: workers) {
+        worker.join();
+    }
+    const auto seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    std::cerr << games << " games in " << seconds << " s (" << workers.size() << " threads)\n";
+
+    const std::vector<Report> reports { MakeReport(configs[0], sides[0]), MakeReport(configs[1], sides[1]) };
+    if(csv) {
+        PrintCsv(reports);
+    }
+    else {
+        PrintJson(reports);
+    }
+    return 0;
+}
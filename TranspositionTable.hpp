@@ -0,0 +1,67 @@
+#ifndef TRANSPOSITION_TABLE_HPP_
+#define TRANSPOSITION_TABLE_HPP_
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace solution {
+
+/**
+ * Fixed size hash table of already evaluated positions.
+ * On collision the old entry is replaced.
+ * `Clear` is O(1): it only invalidates all entries stored before.
+ * @tparam Key_t the position (e.g. canonical form of the board) with `hash()`
+ */
+template<class Key_t>
+class TranspositionTable final {
+public:
+    static constexpr size_t CAPACITY { 1u << 12u };
+
+    enum class Bound: uint8_t { EXACT, LOWER, UPPER };
+
+    struct Entry {
+        Key_t       m_key {};
+        float       m_value { 0.f };
+        uint32_t    m_generation { 0 };
+        int16_t     m_depth { 0 };
+        uint8_t     m_move { 0 };
+        Bound       m_bound { Bound::EXACT };
+    };
+
+    void Clear() noexcept {
+        m_generation++;
+    }
+
+    /**
+     * @return the stored entry or nullptr if the position is unknown
+     */
+    const Entry* Find(const Key_t& key) const noexcept {
+        const auto& entry = m_entries[Slot(key)];
+        return entry.m_generation == m_generation && entry.m_key == key? &entry : nullptr;
+    }
+
+    void Store(const Key_t& key, float value, Bound bound, int depth, size_t move) noexcept {
+        auto& entry = m_entries[Slot(key)];
+        entry.m_key = key;
+        entry.m_value = value;
+        entry.m_generation = m_generation;
+        entry.m_depth = static_cast<int16_t>(depth);
+        entry.m_move = static_cast<uint8_t>(move);
+        entry.m_bound = bound;
+    }
+
+private:
+    static size_t Slot(const Key_t& key) noexcept {
+        // Fibonacci hashing
+        return static_cast<size_t>((key.hash() * 11400714819323198485ull) >> 52u) & (CAPACITY - 1u);
+    }
+
+    std::vector<Entry> m_entries { CAPACITY };
+    // entries of the previous generations are considered empty
+    uint32_t m_generation { 1 };
+};
+
+} // namespace solution
+
+#endif // TRANSPOSITION_TABLE_HPP_
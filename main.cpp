@@ -1,10 +1,20 @@
+#include <algorithm>
 #include <iostream>
 #include <chrono>
 #include <memory>
+#include <string>
+#include <thread>
 
 #include "Board.hpp"
 #include "Minimax.hpp"
 #include "MCTS.hpp"
+#include "PerfectPlay.hpp"
+#include "Negamax.hpp"
+#include "Playout.hpp"
+#include "Batch.hpp"
+#include "Deadline.hpp"
+#include "Tablebase.hpp"
+#include "Server.hpp"
 
 using namespace game;
 
@@ -27,23 +37,53 @@ bool IsFinished(Board board) {
     return isFinished;
 }
 
-int main(int, char**) {
+// tic-tac-toe --headless [--socket <path>] [--threads <n>], see `solution::Server`
+int Headless(int argc, char** argv) {
+    std::string socket;
+    size_t threads { std::max(1u, std::thread::hardware_concurrency()) };
+    for(int i = 2; i < argc; i++) {
+        const std::string arg { argv[i] };
+        if(arg == "--socket" && i + 1 < argc) {
+            socket = argv[++i];
+        }
+        else if(arg == "--threads" && i + 1 < argc) {
+            threads = std::max<size_t>(1, std::stoul(argv[++i]));
+        }
+        else {
+            std::cerr << "Usage: " << argv[0] << " --headless [--socket <path>] [--threads <n>]\n";
+            return 1;
+        }
+    }
+    return socket.empty()? solution::ServeStdio(threads) : solution::ServeSocket(socket, threads);
+}
+
+int main(int argc, char** argv) {
+    if(argc > 1 && std::string { argv[1] } == "--headless") {
+        return Headless(argc, argv);
+    }
+
     TestBoard();
+    TestPerfectPlay();
+    TestPlayout();
+    TestMCTS();
+    TestBatchSolver();
+    TestDeadline();
+    TestTablebase();
+    TestServer();
     
     uint64_t microsecs = 16'666;
     uint64_t iterations = 5000;
     uint64_t nodes = 10000;
     uint8_t player = 1;
-    auto playerMapping = [](uint8_t player) {
-        return player == 0? Board::Cell::X : Board::Cell::O;
-    };
 
-    enum Kind { kMCTS, kAlphaBetta, kMinimax };
+    enum Kind { kMCTS, kAlphaBetta, kMinimax, kPerfectPlay, kNegamax };
     using SolverPointer = std::unique_ptr<solution::Solver>;
-    SolverPointer algos[3] = {
-        SolverPointer { new solution::MCTS { microsecs, iterations, nodes, player, std::move(playerMapping) } }
-        , SolverPointer { new solution::AlphaBettaMinimax { player, std::move(playerMapping) } }
-        , SolverPointer { new solution::Minimax { player, std::move(playerMapping) } }
+    SolverPointer algos[5] = {
+        SolverPointer { new solution::MCTS { microsecs, iterations, nodes, player } }
+        , SolverPointer { new solution::AlphaBettaMinimax { player } }
+        , SolverPointer { new solution::Minimax { player } }
+        , SolverPointer { new solution::PerfectPlay { player } }
+        , SolverPointer { new solution::Negamax { player } }
     };
     Board board {};
     while(true) {
@@ -59,7 +99,8 @@ int main(int, char**) {
         if(IsFinished(board)) break;
 
         // AI move
-        auto move = algos[kAlphaBetta]->Run(board);
+        // the move must be made within the frame
+        auto move = algos[kAlphaBetta]->Run(board, solution::Deadline::After(microsecs));
         algos[kAlphaBetta]->Print(std::cout);
         board.assign(move / 3, move % 3, Board::Cell::O);       
         if(IsFinished(board)) {